@@ -0,0 +1,20 @@
+#pragma once
+
+// C++ standard libraries
+#include <charconv>
+#include <cstring>
+#include <system_error>
+
+
+// Whole argument as a number, not negative, as rank and rank-bt read them
+template<typename T>
+bool parseNumber(const char* text, T& value) {
+    T parsed;
+    const char* end = text + std::strlen(text);
+    auto [last, error] = std::from_chars(text, end, parsed);
+    if (error != std::errc() || last != end || last == text || parsed < 0)
+        return false;
+
+    value = parsed;
+    return true;
+}
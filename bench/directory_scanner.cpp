@@ -0,0 +1,140 @@
+// C++ standard libraries
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Custom libraries
+#include "arguments.hpp"
+#include "directory_scanner.hpp"
+#include "picture_names.hpp"
+#include "scan_manifest.hpp"
+
+
+static const char* usage = "Usage: rank-bench-scan [-d directories] [-f files per directory] [folder]";
+
+
+// Every allocation of the program
+static std::atomic<std::size_t> allocations = 0;
+
+
+void* operator new(std::size_t size) {
+    allocations++;
+
+    if (void* pointer = std::malloc(size ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+
+// Streams the folder as the loader does
+static void scan(const std::string& root, PictureNames& names, ScanManifest* manifest,
+                    std::vector<PictureRecord>& pictures, const char* label) {
+    DirectoryScanner scanner(names, ScanOptions{true, 0}, manifest);
+
+    std::size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+
+    scanner.scan(root, [&pictures](std::vector<PictureRecord>&& batch) {
+        pictures.insert(pictures.end(), batch.begin(), batch.end());
+        return true;
+    });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::size_t count = allocations - before;
+
+    std::cout << label << ": " << pictures.size() << " pictures in " << elapsed.count() << " s, "
+              << count << " allocations (" << 1.0 * count / std::max<std::size_t>(pictures.size(), 1)
+              << " per picture), " << scanner.getStats().arenaBlocks << " arena blocks" << std::endl;
+}
+
+
+// Allocations of a scan: listing, and restoring from the manifest.
+// Without a folder a tree of empty files is made in the temporary directory
+int main(int argc, char* argv[]) {
+    std::size_t directories = 100;
+    std::size_t files = 1000;
+    std::string root;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool valid = true;
+
+        if (argument == "-d" && i + 1 < argc)
+            valid = parseNumber(argv[++i], directories);
+        else if (argument == "-f" && i + 1 < argc)
+            valid = parseNumber(argv[++i], files);
+        else if (argument.starts_with("-"))
+            valid = false;
+        else
+            root = argument;
+
+        if (!valid) {
+            std::cerr << "Invalid argument " << argv[i] << std::endl << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    bool generated = root.empty();
+    if (generated) {
+        root = (std::filesystem::temp_directory_path() / "rank-bench-scan").string();
+        std::filesystem::remove_all(root);
+
+        for (std::size_t d = 0; d < directories; d++) {
+            std::filesystem::path directory = std::filesystem::path(root) / ("directory_" + std::to_string(d));
+            std::filesystem::create_directories(directory);
+
+            for (std::size_t f = 0; f < files; f++)
+                std::ofstream(directory / ("IMG_2024_" + std::to_string(d) + "_" + std::to_string(f) + ".jpg"));
+        }
+    }
+
+    {
+        PictureNames names;
+        std::vector<PictureRecord> pictures;
+        scan(root, names, nullptr, pictures, "Listing");
+    }
+
+    // The second manifest sees the directories unchanged
+    std::string manifestFolder = (std::filesystem::temp_directory_path() / "rank-bench-scan-manifest").string();
+    std::filesystem::create_directories(manifestFolder);
+    {
+        PictureNames names;
+        std::vector<PictureRecord> pictures;
+        ScanManifest manifest(manifestFolder);
+        scan(root, names, &manifest, pictures, "Listing for the manifest");
+
+        // Only hashed files are restored
+        for (auto& picture : pictures)
+            manifest.updateFile(names.getPath(picture.file), ScanManifest::FileEntry{0, 0, 1, 0});
+        manifest.save();
+    }
+    {
+        PictureNames names;
+        std::vector<PictureRecord> pictures;
+        ScanManifest manifest(manifestFolder);
+        scan(root, names, &manifest, pictures, "Restoring from the manifest");
+    }
+
+    std::filesystem::remove_all(manifestFolder);
+    if (generated)
+        std::filesystem::remove_all(root);
+
+    return EXIT_SUCCESS;
+}
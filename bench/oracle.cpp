@@ -0,0 +1,333 @@
+// C++ standard libraries
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Custom libraries
+#include "arguments.hpp"
+#include "picture_record.hpp"
+#include "pair_selector.hpp"
+#include "random_pair_selector.hpp"
+#include "schedule_pair_selector.hpp"
+#include "insertion_sorter.hpp"
+#include "tournament_bracket.hpp"
+#include "elo_rating.hpp"
+#include "glicko_rating.hpp"
+#include "ranking.hpp"
+#include "sort_key.hpp"
+
+
+static const char* usage =
+    "Usage: rank-bench-oracle [-m random|sort|top] [-k key] [-e noise] [-t tau] [-b votes per picture] [--min n] [--max n] [-s seed]";
+
+
+// Pair selectors, that can be simulated
+static const std::vector<std::string> selectorNames{"random", "sort", "top"};
+
+// Pictures wanted by the top selector, as the app by default
+static constexpr std::size_t topCount = 10;
+
+
+// Settings of the sweep
+struct OracleOptions {
+    std::vector<std::string> selectors = selectorNames;
+    std::size_t minCount = 100;
+
+    // A run at 100k pictures takes up to a minute, at 1M tens of minutes
+    std::size_t maxCount = 10000;
+    double noise = 0.5;
+    double target = 0.9;
+
+    // Ranking compared with the hidden one. By default the one
+    // of the mode: the sort or the tournament, Elo for random
+    std::optional<SortKey> key;
+
+    // Votes per picture, before giving up
+    double budget = 100.0;
+
+    std::uint32_t seed = 42;
+};
+
+
+// Result of one run
+struct OracleResult {
+    std::size_t votes;
+    double tau;
+    double seconds;
+    bool reached;
+};
+
+
+// Pairs of the sequence out of order, sorts it
+static std::uint64_t countInversions(std::vector<std::uint32_t>& sequence, std::vector<std::uint32_t>& buffer) {
+    std::uint64_t inversions = 0;
+    buffer.resize(sequence.size());
+
+    // Bottom-up merge sort
+    for (std::size_t width = 1; width < sequence.size(); width *= 2) {
+        for (std::size_t begin = 0; begin < sequence.size(); begin += 2 * width) {
+            std::size_t middle = std::min(begin + width, sequence.size());
+            std::size_t end = std::min(begin + 2 * width, sequence.size());
+
+            std::size_t i = begin, j = middle, k = begin;
+            while (i < middle && j < end) {
+                if (sequence[j] < sequence[i]) {
+                    inversions += middle - i;
+                    buffer[k++] = sequence[j++];
+                }
+                else
+                    buffer[k++] = sequence[i++];
+            }
+            k = std::copy(sequence.begin() + i, sequence.begin() + middle, buffer.begin() + k) - buffer.begin();
+            std::copy(sequence.begin() + j, sequence.begin() + end, buffer.begin() + k);
+        }
+
+        sequence.swap(buffer);
+    }
+
+    return inversions;
+}
+
+
+// Scores of the pictures by the key, higher is better. The sort and
+// the tournament give a score by place, the pictures without a place
+// tie below all placed ones
+static void getScores(const std::vector<PictureRecord>& pictures, SortKey key,
+                        const ComparisonSchedule* schedule, std::vector<double>& scores) {
+    scores.assign(pictures.size(), 0.0);
+
+    if (key == SortKey::SORT || key == SortKey::TOP) {
+        // Ids are indices here
+        const std::vector<std::uint32_t>& ids = schedule->getOrder();
+        for (std::size_t place = 0; place < ids.size(); place++)
+            scores[ids[place]] = ids.size() - place;
+        return;
+    }
+
+    for (std::size_t i = 0; i < pictures.size(); i++)
+        scores[i] = Ranking::score(pictures[i], key);
+}
+
+
+// Kendall tau between the order by the scores and the hidden one,
+// O(n log n). Pairs with the same score neither agree nor disagree
+static double kendallTau(const std::vector<double>& scores, const std::vector<std::uint32_t>& trueRanks,
+                            std::vector<std::uint32_t>& order, std::vector<std::uint32_t>& buffer) {
+    // Ties are put in the hidden order, so they are not inversions
+    order.resize(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        if (scores[a] != scores[b])
+            return scores[a] < scores[b];
+        return trueRanks[a] < trueRanks[b];
+    });
+
+    double ties = 0.0;
+    for (std::size_t begin = 0, end = 0; begin < order.size(); begin = end) {
+        while (end < order.size() && scores[order[end]] == scores[order[begin]])
+            end++;
+        ties += 0.5 * (end - begin) * (end - begin - 1.0);
+    }
+
+    for (auto& index : order)
+        index = trueRanks[index];
+
+    double pairs = 0.5 * scores.size() * (scores.size() - 1.0);
+    return (pairs - ties - 2.0 * countInversions(order, buffer)) / pairs;
+}
+
+
+// Ranking a selector is compared by
+static SortKey keyOf(const std::string& selectorName, const OracleOptions& options) {
+    if (options.key)
+        return *options.key;
+    if (selectorName == "sort")
+        return SortKey::SORT;
+    if (selectorName == "top")
+        return SortKey::TOP;
+    return SortKey::ELO;
+}
+
+
+// Votes of a simulated voter, until the ranking is close
+// enough to the hidden one. The voter sees every quality with
+// normal noise, so close pictures are often mixed up
+static OracleResult simulate(const std::string& selectorName, std::size_t count, const OracleOptions& options) {
+    std::mt19937 gen(options.seed);
+
+    // Hidden quality, and the rank it gives, worst is 0
+    std::normal_distribution<double> quality(0.0, 1.0);
+    std::vector<double> qualities(count);
+    for (auto& value : qualities)
+        value = quality(gen);
+
+    std::vector<std::uint32_t> byQuality(count);
+    std::iota(byQuality.begin(), byQuality.end(), 0);
+    std::sort(byQuality.begin(), byQuality.end(), [&qualities](std::uint32_t a, std::uint32_t b) {
+        return qualities[a] < qualities[b];
+    });
+
+    std::vector<std::uint32_t> trueRanks(count);
+    for (std::size_t rank = 0; rank < count; rank++)
+        trueRanks[byQuality[rank]] = rank;
+
+    std::vector<PictureRecord> pictures(count);
+    for (std::size_t i = 0; i < count; i++)
+        pictures[i] = PictureRecord{.file = static_cast<std::uint32_t>(i), .id = static_cast<std::uint32_t>(i), .hash = i + 1};
+
+    // The sort and the tournament are kept in memory, every run starts over
+    std::unique_ptr<ComparisonSchedule> schedule;
+    if (selectorName == "sort")
+        schedule = std::make_unique<InsertionSorter>("");
+    else if (selectorName == "top")
+        schedule = std::make_unique<TournamentBracket>("", topCount);
+
+    std::unique_ptr<PairSelector> selector;
+    if (schedule) {
+        // Every picture is known, as once loading ends in the app
+        for (auto& picture : pictures)
+            schedule->add(picture.id);
+        schedule->retain(pictures);
+
+        selector = std::make_unique<SchedulePairSelector>(*schedule, options.seed);
+    }
+    else
+        selector = std::make_unique<RandomPairSelector>(options.seed);
+
+    GlickoRating glickoRating;
+    std::normal_distribution<double> perception(0.0, options.noise);
+
+    // Tau is checked after every quarter of a vote per picture
+    std::size_t checkEvery = std::max<std::size_t>(count / 4, 50);
+    std::size_t budget = options.budget * count;
+    SortKey key = keyOf(selectorName, options);
+    std::vector<double> scores;
+    std::vector<std::uint32_t> order, buffer;
+
+    // Ratings are up to date, as in the rank menu
+    auto measure = [&]() {
+        glickoRating.closePeriod(pictures);
+        getScores(pictures, key, schedule.get(), scores);
+        return kendallTau(scores, trueRanks, order, buffer);
+    };
+
+    auto accept = [](std::size_t first, std::size_t second) { return first != second; };
+
+    OracleResult result{0, 0.0, 0.0, false};
+    auto start = std::chrono::steady_clock::now();
+
+    while (result.votes < budget) {
+        std::size_t left, right;
+        if (!selector->choose(pictures, accept, left, right))
+            break;
+
+        bool leftWins = qualities[left] + perception(gen) > qualities[right] + perception(gen);
+        std::size_t winner = leftWins ? left : right;
+        std::size_t loser = leftWins ? right : left;
+
+        // As MainMenu::recordVote() does
+        pictures[winner].wins++;
+        pictures[winner].total++;
+        pictures[loser].total++;
+        EloRating::update(pictures[winner], pictures[loser]);
+        glickoRating.record(pictures, winner, loser);
+        selector->record(pictures, winner, loser);
+
+        if (++result.votes % checkEvery == 0) {
+            result.tau = measure();
+            if (result.tau >= options.target) {
+                result.reached = true;
+                break;
+            }
+        }
+    }
+
+    if (!result.reached)
+        result.tau = measure();
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+
+// Votes needed to reach a Kendall tau with a hidden ranking,
+// for pair selectors at growing numbers of pictures. CSV on stdout
+int main(int argc, char* argv[]) {
+    OracleOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool valid = false;
+
+        if (argument == "-m" && i + 1 < argc) {
+            std::string name = argv[++i];
+            valid = std::find(selectorNames.begin(), selectorNames.end(), name) != selectorNames.end();
+            options.selectors = {name};
+        }
+        else if (argument == "-k" && i + 1 < argc) {
+            // Names as in the rank menu, any case, the orders of the modes too
+            std::string name = argv[++i];
+            for (std::size_t k = 0; k <= static_cast<std::size_t>(SortKey::TOP); k++) {
+                SortKey key = static_cast<SortKey>(k);
+                std::string keyName = Ranking::name(key);
+                if (std::equal(name.begin(), name.end(), keyName.begin(), keyName.end(),
+                        [](char a, char b) { return std::tolower(a) == std::tolower(b); })) {
+                    options.key = key;
+                    valid = true;
+                }
+            }
+        }
+        else if (argument == "-e" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.noise);
+        else if (argument == "-t" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.target) && options.target <= 1.0;
+        else if (argument == "-b" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.budget);
+        else if (argument == "--min" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.minCount);
+        else if (argument == "--max" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.maxCount);
+        else if (argument == "-s" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.seed);
+
+        if (!valid) {
+            std::cerr << "Invalid argument " << argv[i] << std::endl << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The order of the sort is there only when sorting, so is the tournament
+    if (options.key == SortKey::SORT || options.key == SortKey::TOP) {
+        std::string mode = options.key == SortKey::SORT ? "sort" : "top";
+        if (options.selectors.size() == 1 && options.selectors[0] != mode) {
+            std::cerr << "The key " << Ranking::name(*options.key) << " needs -m " << mode << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        options.selectors = {mode};
+    }
+
+    std::cout << "selector,key,pictures,noise,target,votes,votes_per_picture,tau,reached,seconds" << std::endl;
+
+    // Ten times more pictures every step
+    for (std::size_t count = std::max<std::size_t>(options.minCount, 2); count <= options.maxCount; count *= 10) {
+        for (auto& selector : options.selectors) {
+            OracleResult result = simulate(selector, count, options);
+
+            std::cout << selector << ',' << Ranking::name(keyOf(selector, options)) << ',' << count << ',' << options.noise << ',' << options.target << ','
+                      << result.votes << ',' << 1.0 * result.votes / count << ',' << result.tau << ','
+                      << result.reached << ',' << result.seconds << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+// C++ standard libraries
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Custom libraries
+#include "arguments.hpp"
+#include "picture_record.hpp"
+#include "elo_rating.hpp"
+#include "ranking.hpp"
+
+
+static const char* usage = "Usage: rank-bench-records [-n pictures] [-v votes] [-c scans]";
+
+
+// Milliseconds since the start
+static double elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// The fields of PictureRecord, a column each
+struct PictureColumns {
+    std::vector<std::uint32_t> file, wins, total, id;
+    std::vector<std::uint64_t> hash, perceptual;
+    std::vector<bool> removed;
+    std::vector<std::uint32_t> period;
+    std::vector<double> elo, glicko, deviation, volatility;
+
+    explicit PictureColumns(std::size_t count) :
+            file(count), wins(count), total(count), id(count),
+            hash(count), perceptual(count),
+            removed(count), period(count),
+            elo(count, 1500.0), glicko(count, 1500.0), deviation(count, 350.0), volatility(count, 0.06) {}
+};
+
+
+// What a vote reads and writes of both pictures: counters, Elo,
+// the id for the log, removal for the selector, and the Glicko
+// fields, once its period closes
+static void vote(std::vector<PictureRecord>& pictures, std::size_t winner, std::size_t loser, std::uint64_t& checksum) {
+    pictures[winner].wins++;
+    pictures[winner].total++;
+    pictures[loser].total++;
+    EloRating::update(pictures[winner], pictures[loser]);
+    checksum += pictures[winner].id ^ pictures[loser].id;
+
+    for (std::size_t index : {winner, loser}) {
+        PictureRecord& picture = pictures[index];
+        checksum += picture.removed;
+        picture.deviation = 0.99 * picture.deviation + 0.001 * picture.volatility * picture.glicko;
+        picture.period++;
+    }
+}
+
+
+static void vote(PictureColumns& columns, std::size_t winner, std::size_t loser, std::uint64_t& checksum) {
+    columns.wins[winner]++;
+    columns.total[winner]++;
+    columns.total[loser]++;
+    double change = EloRating::factor * (1.0 - EloRating::expected(columns.elo[winner], columns.elo[loser]));
+    columns.elo[winner] += change;
+    columns.elo[loser] -= change;
+    checksum += columns.id[winner] ^ columns.id[loser];
+
+    for (std::size_t index : {winner, loser}) {
+        checksum += columns.removed[index];
+        columns.deviation[index] = 0.99 * columns.deviation[index] + 0.001 * columns.volatility[index] * columns.glicko[index];
+        columns.period[index]++;
+    }
+}
+
+
+// Cost of the picture records as one array of structures, and as
+// a column per field, for the two ways they are used: a vote touches
+// most fields of two pictures, a scan reads one or two fields of all
+int main(int argc, char* argv[]) {
+    std::size_t count = 1000000;
+    std::size_t votes = 1000000;
+    std::size_t scans = 20;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool valid = false;
+
+        if (argument == "-n" && i + 1 < argc)
+            valid = parseNumber(argv[++i], count) && count > 0;
+        else if (argument == "-v" && i + 1 < argc)
+            valid = parseNumber(argv[++i], votes);
+        else if (argument == "-c" && i + 1 < argc)
+            valid = parseNumber(argv[++i], scans) && scans > 0;
+
+        if (!valid) {
+            std::cerr << "Invalid argument " << argv[i] << std::endl << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<PictureRecord> pictures(count);
+    PictureColumns columns(count);
+    for (std::size_t i = 0; i < count; i++)
+        pictures[i].id = columns.id[i] = i;
+
+    // Same pairs for both
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> random(0, count - 1);
+    std::vector<std::size_t> pairs(2 * votes);
+    for (auto& index : pairs)
+        index = random(gen);
+
+    std::uint64_t checksum = 0;
+
+    // Votes //
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < votes; i++)
+        vote(pictures, pairs[2 * i], pairs[2 * i + 1], checksum);
+    double arrayVotes = elapsed(start) * 1e6 / votes;
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < votes; i++)
+        vote(columns, pairs[2 * i], pairs[2 * i + 1], checksum);
+    double columnVotes = elapsed(start) * 1e6 / votes;
+
+    std::cout << "vote: " << arrayVotes << " ns records, " << columnVotes << " ns columns" << std::endl;
+
+    // Scans by the Bayes key, wins and total of every picture //
+
+    double sum = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (std::size_t scan = 0; scan < scans; scan++) {
+        for (auto& picture : pictures)
+            sum += Ranking::bayes(picture.wins, picture.total);
+    }
+    double arrayScan = elapsed(start) / scans;
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t scan = 0; scan < scans; scan++) {
+        for (std::size_t i = 0; i < count; i++)
+            sum += Ranking::bayes(columns.wins[i], columns.total[i]);
+    }
+    double columnScan = elapsed(start) / scans;
+
+    std::cout << "scan: " << arrayScan << " ms records, " << columnScan << " ms columns" << std::endl;
+    std::cout << "(" << (checksum + static_cast<std::uint64_t>(sum)) % 10 << ")" << std::endl;
+
+    return 0;
+}
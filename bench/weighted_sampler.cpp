@@ -0,0 +1,94 @@
+// C++ standard libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Custom libraries
+#include "arguments.hpp"
+#include "weighted_sampler.hpp"
+
+
+static const char* usage = "Usage: rank-bench-sampler [-n entries] [-v votes]";
+
+
+// Microseconds since the start
+static double elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// Cost of one vote on a weighted sampler: two weights change,
+// then a pair is drawn. Compared with rebuilding
+// std::discrete_distribution, which every vote would need otherwise
+int main(int argc, char* argv[]) {
+    std::size_t count = 1000000;
+    std::size_t votes = 1000000;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool valid = false;
+
+        if (argument == "-n" && i + 1 < argc)
+            valid = parseNumber(argv[++i], count) && count > 0;
+        else if (argument == "-v" && i + 1 < argc)
+            valid = parseNumber(argv[++i], votes);
+
+        if (!valid) {
+            std::cerr << "Invalid argument " << argv[i] << std::endl << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> random(0, count - 1);
+
+    std::vector<double> weights(count);
+    std::vector<std::size_t> totals(count);
+    for (std::size_t i = 0; i < count; i++) {
+        totals[i] = random(gen) % 20;
+        weights[i] = 1.0 / (1.0 + totals[i]);
+    }
+
+    WeightedSampler sampler;
+
+    auto start = std::chrono::steady_clock::now();
+    sampler.assign(weights);
+    std::cout << "build: " << elapsed(start) / 1000 << " ms" << std::endl;
+
+    // Votes with the Fenwick tree
+    std::size_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (std::size_t vote = 0; vote < votes; vote++) {
+        std::size_t left = sampler.sample(gen);
+        std::size_t right = sampler.sample(gen);
+        checksum += left ^ right;
+
+        sampler.set(left, 1.0 / (2.0 + totals[left]++));
+        sampler.set(right, 1.0 / (2.0 + totals[right]++));
+    }
+    double perVote = elapsed(start) / votes;
+    std::cout << "fenwick: " << perVote * 1000 << " ns per vote" << std::endl;
+
+    // Votes rebuilding the distribution, only a few, they are slow
+    std::size_t rebuilds = std::max<std::size_t>(votes / 100000, 3);
+    start = std::chrono::steady_clock::now();
+    for (std::size_t vote = 0; vote < rebuilds; vote++) {
+        std::discrete_distribution<std::size_t> distribution(weights.begin(), weights.end());
+        std::size_t left = distribution(gen);
+        std::size_t right = distribution(gen);
+        checksum += left ^ right;
+
+        weights[left] = 1.0 / (2.0 + totals[left]++);
+        weights[right] = 1.0 / (2.0 + totals[right]++);
+    }
+    double perRebuild = elapsed(start) / rebuilds;
+    std::cout << "rebuild: " << perRebuild * 1000 << " ns per vote" << std::endl;
+
+    std::cout << "speedup: " << perRebuild / perVote << "x (" << checksum % 10 << ")" << std::endl;
+
+    return 0;
+}
@@ -5,12 +5,32 @@
 #include "menu_events.hpp"
 #include "base_menu.hpp"
 #include "picture_record.hpp"
+#include "picture_names.hpp"
 #include "data_handler.hpp"
+#include "comparison_log.hpp"
+#include "picture_hasher.hpp"
+#include "directory_scanner.hpp"
+#include "picture_loader.hpp"
+#include "directory_watcher.hpp"
+#include "scan_manifest.hpp"
+#include "duplicate_index.hpp"
+#include "sort_key.hpp"
+#include "glicko_rating.hpp"
+#include "pair_history.hpp"
+#include "preference_graph.hpp"
+#include "convergence_tracker.hpp"
+#include "ranking_index.hpp"
+#include "pair_selector.hpp"
+#include "comparison_schedule.hpp"
+#include "selection_mode.hpp"
+#include "event_source.hpp"
+#include "session_options.hpp"
 
 // C++ standard libraries
 #include <filesystem>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 // Application class
 // The main features:
@@ -19,15 +39,91 @@
 class Application {
     // Screen for showing pictures
     Screen screen;
+
+    // Names and directories of the files in pictures
+    PictureNames pictureNames;
     DataHandler dataHandler;
 
+    // Folder contents and hashes from the last run
+    ScanManifest scanManifest;
+    PictureHasher pictureHasher;
+
+    // Changes of the folder while running
+    DirectoryWatcher directoryWatcher;
+
+    // Fills pictures in the background
+    PictureLoader pictureLoader;
+
+    // Every comparison made in the app
+    ComparisonLog comparisonLog;
+
     // Pictures information
     std::vector<PictureRecord> pictures;
     std::string pathToPictures;
 
+    // Position of every content in pictures
+    std::unordered_map<std::uint64_t, std::size_t> pictureIndex;
+
+    // Ids of received pictures are below
+    std::uint32_t receivedIds;
+
+    // Position of every present file in pictures
+    std::unordered_map<std::string, std::size_t> pathIndex;
+
+    // Position of every id in pictures
+    std::unordered_map<std::uint32_t, std::size_t> idIndex;
+
+    // Groups of pictures, that look the same
+    DuplicateIndex duplicateIndex;
+
+    // Uncertainty-aware ratings
+    GlickoRating glickoRating;
+
+    // Pairs compared before, in this or earlier sessions
+    PairHistory pairHistory;
+
+    // Orders implied by the votes
+    PreferenceGraph preferenceGraph;
+
+    // Whether the ranking still changes
+    ConvergenceTracker convergenceTracker;
+
+    // Order of pictures by every sort key
+    RankingIndex rankingIndex;
+
+    // Questions of the sort and tournament modes,
+    // resumed from the last session
+    std::unique_ptr<ComparisonSchedule> schedule;
+
+    // Chooses pairs for the main menu. Pictures never move,
+    // so it keeps what it knows between menus
+    std::unique_ptr<PairSelector> pairSelector;
+
+    // Pictures of the schedule, that are gone, were dropped
+    bool scheduleRetained;
+
     // Font position
     std::string pathToFont;
 
+    // Order of the rank menu, chosen there
+    SortKey sortKey;
+
+    // How pairs to compare are chosen
+    SelectionMode selectionMode;
+
+    // Input of the menus: the user, or a recording
+    std::unique_ptr<EventSource> events;
+
+    // Session is recorded or replayed: it must go
+    // the same way every time and keep nothing
+    bool deterministic;
+
+    // Replayed without a window at full speed, frames are timed
+    bool replaying;
+
+    // Seed of choosing pairs
+    std::uint32_t seed;
+
     // Flag for main loop
     bool isRunning;
 
@@ -43,6 +139,10 @@ class Application {
     // See the counters and pictures in order
     void switchToRank(MenuEvent event);
 
+    // Positions of the pictures placed by the schedule, best first,
+    // if the key is the order of the selection mode
+    void getScheduleOrder(SortKey key, std::vector<std::uint32_t>& order) const;
+
 
     void handleEvents();
 
@@ -55,11 +155,33 @@ class Application {
     // Debug information into ostream
     void debug() const;
 
-    // Checks if given directory entry is picture
-    bool isPicture(const std::filesystem::directory_entry& entry) const;
+    // Take pictures discovered since the last frame.
+    // Leaves only one picture of every content
+    void receivePictures();
+
+    // Apply changes of the folder: new pictures go to
+    // the loader, removed ones are marked in place
+    void watchPictures();
+
+    // Mark the picture as gone, its statistics stay
+    void removePicture(std::size_t index);
+
+    // Save statistics, if some picture has an id, that is not saved
+    void saveNewIds();
+
+    // Strategy of choosing pairs for the selection mode
+    std::unique_ptr<PairSelector> makePairSelector();
+
+    // Block until the whole folder is loaded
+    void waitForPictures();
+
+    // Votes and frame times of a replay
+    void reportTiming(std::size_t votes, std::vector<double>& frameTimes) const;
 public:
     Application(std::size_t w, std::size_t h, const std::string& pathToPictures, 
-                    const std::string& pathToFont, std::string pathToBackground = "");
+                    const std::string& pathToFont, std::string pathToBackground = "",
+                    ScanOptions scanOptions = {}, SelectionMode selectionMode = SelectionMode::RANDOM,
+                    std::size_t topCount = 10, SessionOptions sessionOptions = {});
 
     // Application main loop
     int run();
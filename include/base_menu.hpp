@@ -3,6 +3,7 @@
 // Custom libraries
 #include "menu_events.hpp"
 #include "screen.hpp"
+#include "event_source.hpp"
 
 // Interface for menus
 class BaseMenu {
@@ -11,11 +12,11 @@ class BaseMenu {
     virtual MenuEvent handleSpecificEvent(const SDL_Event& event, Screen& screen) = 0;
 
 public:
-    // Handle default events
+    // Handle default events of the frame
     // - Close
     // - Resize
     // - Maximize
-    virtual MenuEvent handleEvents(Screen& screen);
+    virtual MenuEvent handleEvents(Screen& screen, EventSource& events);
 
     // Give the information whether an application should update and render the frame
     virtual bool toUpdate();
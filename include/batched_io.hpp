@@ -0,0 +1,67 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Batches small file operations into few syscalls.
+// On Linux a whole batch of statx calls, opens, reads and
+// closes is submitted to io_uring at once. Operations, that
+// the kernel refuses (or every operation, if io_uring is not
+// available), are done one by one with stat and pread.
+// One instance is used by one thread at a time.
+class BatchedIo {
+public:
+    struct FileStatus {
+        bool exists;
+        std::uint64_t size;
+        std::int64_t mtime;     // nanoseconds
+    };
+
+private:
+    // Fills the submission entry for the operation with the index
+    using Prepare = std::function<void(std::size_t, void*)>;
+
+    // io_uring descriptor, -1 for the fallback
+    int ringFd;
+    unsigned entries;
+
+    // Memory shared with the kernel
+    void* submissionRing, * completionRing, * submissionEntries;
+    std::size_t submissionRingSize, completionRingSize, submissionEntriesSize;
+
+    // Fields of the rings
+    unsigned* submissionTail, * submissionMask, * submissionArray;
+    unsigned* completionHead, * completionTail, * completionMask;
+    void* completionEntries;
+
+    void setup();
+    void teardown();
+
+    // Run count operations, at most entries at a time.
+    // results gets the result of every operation,
+    // -ENOSYS for those, that were not run
+    void submitBatch(std::size_t count, const Prepare& prepare, std::vector<std::int32_t>& results);
+
+public:
+    BatchedIo(unsigned entries = 64);
+
+    BatchedIo(const BatchedIo&) = delete;
+    BatchedIo& operator=(const BatchedIo&) = delete;
+
+    // Whether io_uring is used
+    bool isBatched() const;
+
+    // Size and modification time of every file
+    void stat(const std::vector<std::string>& paths, std::vector<FileStatus>& statuses);
+
+    // Read every file completely. Buffers are reused,
+    // succeeded tells which files were read
+    void read(const std::vector<std::string>& paths,
+                std::vector<std::vector<unsigned char>>& buffers, std::vector<bool>& succeeded);
+
+    ~BatchedIo();
+};
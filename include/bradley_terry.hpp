@@ -0,0 +1,78 @@
+#pragma once
+
+// Custom libraries
+#include "comparison_log.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct BradleyTerryOptions {
+    // Stop once no strength changes by more than this (relative)
+    double tolerance = 1e-6;
+    std::size_t maxIterations = 1000;
+
+    // Every picture gets this many virtual wins and losses
+    // against an average one, so that pictures, that never won
+    // or never lost, still have finite strength
+    double prior = 1.0;
+
+    // 0 - one per core
+    std::size_t threads = 0;
+};
+
+
+// Maximum likelihood Bradley-Terry fit over all recorded comparisons:
+// P(i beats j) = p_i / (p_i + p_j).
+// Games between every two pictures are kept in a sparse symmetric
+// matrix in CSR form, indexed by picture id. Strengths are found by
+// the iterative scaling of Newman (2023), a rearranged MM update
+// (Hunter, 2004), that converges in tens of iterations, not hundreds:
+// p_i <- sum_j w_ij p_j / (p_i + p_j) / sum_j w_ji / (p_i + p_j).
+// Every row is independent, so rows are split between threads.
+class BradleyTerry {
+    // Row of picture i: opponents[offsets[i]..offsets[i + 1]]
+    // and the number of games with each of them
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::uint32_t> opponents;
+    std::vector<std::uint32_t> games;
+
+    // Wins of the row picture over each opponent
+    std::vector<std::uint32_t> beaten;
+
+    std::vector<double> strengths;
+
+    std::size_t iterations;
+    double change;
+
+    // Fill the matrix, forEach goes through comparisons twice
+    template<typename ForEach>
+    void buildFrom(ForEach&& forEach, std::size_t threads);
+
+public:
+    BradleyTerry();
+
+    // Build the matrix from the comparisons
+    void build(const ComparisonLogReader& log, std::size_t threads = 0);
+    void build(const std::vector<Comparison>& comparisons, std::size_t threads = 0);
+
+    // Run iterations until convergence.
+    // Returns false if maxIterations is reached first
+    bool solve(const BradleyTerryOptions& options = {});
+
+    // Strength by picture id, 1 for an average picture
+    const std::vector<double>& getStrengths() const;
+
+    // Strength on the Elo scale: 1500 + 400 * log10(p)
+    double getRating(std::uint32_t id) const;
+
+    // Number of pictures (largest id + 1) and distinct pairs
+    std::size_t getPictureCount() const;
+    std::size_t getPairCount() const;
+
+    std::size_t getIterations() const;
+
+    // Largest relative change in the last iteration
+    double getChange() const;
+};
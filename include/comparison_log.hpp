@@ -0,0 +1,102 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// One recorded matchup between two pictures
+struct Comparison {
+    std::uint32_t winner;
+    std::uint32_t loser;
+
+    // Milliseconds since epoch
+    std::uint64_t timestamp;
+
+    // Identifier of the run of the application:
+    // nanoseconds since epoch at its start
+    std::uint64_t session;
+};
+
+
+// Append-only history of every comparison.
+//
+// The file is a sequence of chunks, one per flush:
+// - header: magic, count, session, base timestamp, sizes of the columns
+// - column of winner ids (varint)
+// - column of loser ids (varint)
+// - column of timestamp deltas (zigzag varint)
+// A typical vote takes 5-8 bytes on disk.
+class ComparisonLog {
+    std::string path;
+    std::uint64_t session;
+
+    // Comparisons not yet written to the file
+    std::vector<Comparison> pending;
+    std::size_t flushThreshold;
+
+    // Called before a chunk is written
+    std::function<void()> beforeWrite;
+
+public:
+    // An empty path keeps nothing
+    ComparisonLog(std::string path, std::size_t flushThreshold = 256);
+
+    // Save whatever the chunk refers to (ids of new pictures)
+    // before the chunk itself, so a crash never leaves
+    // the log pointing to ids, that are not saved
+    void setBeforeWrite(std::function<void()> hook);
+
+    // Remember the matchup, written on the next flush
+    void record(std::uint32_t winner, std::uint32_t loser);
+
+    // Append pending comparisons as a new chunk
+    void flush();
+
+    std::uint64_t getSession() const;
+
+    ~ComparisonLog();
+};
+
+
+// Read-only view of a comparison log mapped into memory
+class ComparisonLogReader {
+    int fd;
+    const std::uint8_t* data;
+    std::size_t size;
+
+    // Decodes the chunk at offset into buffer.
+    // Returns offset of the next chunk, or 0 if the chunk is absent or damaged
+    std::size_t decodeChunk(std::size_t offset, std::vector<Comparison>& buffer) const;
+
+public:
+    explicit ComparisonLogReader(const std::string& path);
+
+    ComparisonLogReader(const ComparisonLogReader&) = delete;
+    ComparisonLogReader& operator=(const ComparisonLogReader&) = delete;
+
+    // Whether the file is mapped
+    bool isOpen() const;
+
+    // Number of comparisons, reads only chunk headers
+    std::size_t count() const;
+
+    // Calls f(const Comparison&) for every comparison in order
+    template<typename F>
+    void forEach(F&& f) const {
+        std::vector<Comparison> buffer;
+        std::size_t offset = 0;
+
+        while (offset < size && (offset = decodeChunk(offset, buffer)) != 0) {
+            for (const auto& comparison : buffer)
+                f(comparison);
+        }
+    }
+
+    // All comparisons at once
+    std::vector<Comparison> readAll() const;
+
+    ~ComparisonLogReader();
+};
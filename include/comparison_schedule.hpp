@@ -0,0 +1,44 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+
+// C++ standard libraries
+#include <cstdint>
+#include <vector>
+
+// Plan of comparisons, where every answer decides the next
+// question: a sort, a tournament. The user is the comparator.
+// Pictures are identified by ids, the state outlives the session
+class ComparisonSchedule {
+public:
+    // New picture to take part
+    virtual void add(std::uint32_t id) = 0;
+
+    // The picture is gone
+    virtual void remove(std::uint32_t id) = 0;
+
+    // Every picture is known: drop the ones, that are absent or removed
+    virtual void retain(const std::vector<PictureRecord>& pictures) = 0;
+
+    // The current question, false if there is none
+    virtual bool next(std::uint32_t& first, std::uint32_t& second) const = 0;
+
+    // Answer to the current question
+    virtual void answer(bool firstWins) = 0;
+
+    // The pictures of the current question are near duplicates, that
+    // are not shown together. The schedule places them without a vote
+    virtual void tie() = 0;
+
+    // Whether the goal is reached
+    virtual bool isDone() const = 0;
+
+    // Picture ids, whose place is decided, best first
+    virtual const std::vector<std::uint32_t>& getOrder() const = 0;
+
+    // Persist the state
+    virtual void save() = 0;
+
+    virtual ~ComparisonSchedule() = default;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Streaming XXH64 - fast non-cryptographic hash of file contents
+class ContentHash {
+    // Accumulators of 32-byte stripes
+    std::uint64_t v1, v2, v3, v4;
+    std::uint64_t seed;
+    std::uint64_t totalLength;
+
+    // Tail of input, that does not fill a stripe yet
+    unsigned char buffer[32];
+    std::size_t buffered;
+
+public:
+    explicit ContentHash(std::uint64_t seed = 0);
+
+    // Feed next portion of data
+    void update(const void* data, std::size_t length);
+
+    // Hash of everything fed so far
+    std::uint64_t digest() const;
+
+    // Hash of a memory block at once
+    static std::uint64_t of(const void* data, std::size_t length, std::uint64_t seed = 0);
+
+    // Hash of the file contents, 0 if the file cannot be read
+    static std::uint64_t ofFile(const std::string& path);
+
+    // Same, the file is kept in contents for other uses
+    static std::uint64_t ofFile(const std::string& path, std::vector<unsigned char>& contents);
+
+    // Fixed-width hexadecimal representation
+    static std::string toHex(std::uint64_t hash);
+
+    // Parse what toHex produced, false if it is something else
+    static bool fromHex(const std::string& hex, std::uint64_t& hash);
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+
+// C++ standard libraries
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Tells, whether the ranking still changes. Every window of votes
+// the ranking by Elo is compared with the one a window ago:
+// - Kendall tau: 1 is the same order, 0 is unrelated
+// - how many of the top pictures stayed in the top
+// - mean rating deviation of present pictures
+// Only pictures, that were touched (a vote, removal, arrival), change.
+// The UI thread copies just them, O(m) for m pictures. The comparison
+// runs on a thread of its own: pairs of a moved and an unmoved picture
+// are counted by binary search in the old order, pairs of two moved
+// ones by inversions in a Fenwick tree, O(m log n). Keeping the order
+// for the next window merges it, O(n).
+class ConvergenceTracker {
+    // Elo rating and id, ordered
+    using Entry = std::pair<double, std::uint32_t>;
+
+    // Copy of a touched picture
+    struct Sample {
+        std::uint32_t id;
+        double elo;
+        double deviation;
+        bool removed;
+    };
+
+    std::size_t window;
+    std::size_t topCount;
+
+    // Of the UI thread //
+
+    // Votes since the last comparison
+    std::size_t votes;
+    bool started;
+
+    // Pictures below are sampled once at least
+    std::size_t seen;
+
+    // Positions touched in this window and the one before. Glicko
+    // changes deviations at the end of a rating period, which may
+    // come after the window of the vote
+    std::vector<std::size_t> changed;
+    std::vector<std::size_t> previous;
+
+    // Of the comparing thread //
+
+    // Pictures a window ago, worst first
+    std::vector<Entry> order;
+
+    // Rating a window ago by id, NaN if the picture was not there
+    std::vector<double> ratings;
+
+    // Deviation counted in the mean by id, NaN if not present
+    std::vector<double> deviations;
+    double deviationSum;
+    std::size_t present;
+
+    // Best pictures a window ago
+    std::vector<std::uint32_t> top;
+
+    // Shared, under the mutex //
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+
+    // Samples of every window, that is not compared yet
+    std::deque<std::vector<Sample>> batches;
+    bool stopping;
+
+    // Results of the last comparison
+    bool compared;
+    double tau;
+    std::size_t topKept;
+    double meanDeviation;
+
+    // Pairs of moved pictures, that changed their order
+    static std::size_t countInversions(std::vector<std::pair<Entry, Entry>>& moved);
+
+    // Send touched pictures to be compared
+    void checkpoint(const std::vector<PictureRecord>& pictures);
+
+    // Compare with the last ranking and remember the current one
+    void compare(std::vector<Sample>& samples);
+
+    void work();
+
+public:
+    ConvergenceTracker(std::size_t window = 100, std::size_t topCount = 10);
+
+    ConvergenceTracker(const ConvergenceTracker&) = delete;
+    ConvergenceTracker& operator=(const ConvergenceTracker&) = delete;
+
+    // The picture at the position changed
+    void touch(std::size_t index);
+
+    // After every vote, ratings are updated
+    void record(const std::vector<PictureRecord>& pictures);
+
+    // Whether two windows are compared already
+    bool isReady() const;
+
+    // Votes left until the next comparison
+    std::size_t getVotesLeft() const;
+
+    std::size_t getWindow() const;
+    std::size_t getTopCount() const;
+
+    double getTau() const;
+    std::size_t getTopKept() const;
+    double getMeanDeviation() const;
+
+    ~ConvergenceTracker();
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+// C++ standard libraries
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+// Passes allocations to the upstream resource and counts them.
+// Placed under an arena, it shows how many blocks the arena took
+class CountingResource : public std::pmr::memory_resource {
+    std::pmr::memory_resource* upstream;
+
+    std::atomic<std::size_t> allocations;
+    std::atomic<std::size_t> bytes;
+
+    virtual void* do_allocate(std::size_t size, std::size_t alignment) override;
+    virtual void do_deallocate(void* pointer, std::size_t size, std::size_t alignment) override;
+    virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    // Allocations and bytes since the start
+    std::size_t getAllocations() const;
+    std::size_t getBytes() const;
+};
@@ -2,10 +2,13 @@
 
 // Custom libraries
 #include "picture_record.hpp"
+#include "picture_names.hpp"
 
 // C++ standard libraries
+#include <atomic>
 #include <string>
 #include <fstream>
+#include <unordered_set>
 #include <vector>
 
 // Library for JSON handling
@@ -14,13 +17,49 @@
 class DataHandler {
     std::string path;
 
+    // Statistics of older versions are keyed by file name
+    PictureNames& names;
+
+    // Statistics read by load()
+    nlohmann::json data;
+
+    // Records under file names, that a picture took already
+    std::unordered_set<std::string> migrated;
+
+    // Next free picture id
+    std::uint32_t nextId;
+
+    // Ids below are in the statistics file
+    std::atomic<std::uint32_t> savedIds;
+
     int getItemInt(nlohmann::json& data, std::string&& itemName) const;
+    double getItemDouble(nlohmann::json& data, std::string&& itemName, double otherwise) const;
     void setItem(nlohmann::json& data, std::string&& itemName, auto value) const;
 
+    // Key of the record in JSON: content hash,
+    // or file name if the hash is unknown
+    std::string getKey(const PictureRecord& picture) const;
+
 public:
-    DataHandler(std::string path);
+    // Statistics of the folder, an empty path starts without any
+    DataHandler(std::string path, PictureNames& names);
+
+    // Read the statistics file
+    void load();
+
+    // Fill the records from loaded statistics, 
+    // new pictures get fresh ids
+    void fill(std::vector<PictureRecord>& pictures);
 
-    void getData(std::vector<PictureRecord>& pictures) const;
+    // load() and fill() at once
+    void getData(std::vector<PictureRecord>& pictures);
+
+    // Records of every picture ever ranked, taken from the loaded
+    // statistics only. Directories are unknown
+    void getRecords(std::vector<PictureRecord>& pictures);
 
     void updateData(const std::vector<PictureRecord>& pictures);
+
+    // Pictures with this id or larger are not saved yet
+    std::uint32_t getSavedIds() const;
 };
\ No newline at end of file
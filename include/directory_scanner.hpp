@@ -0,0 +1,97 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+#include "picture_names.hpp"
+#include "scan_manifest.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// How to look for pictures
+struct ScanOptions {
+    // Descend into subdirectories
+    bool recursive = false;
+
+    // Threads listing directories, 0 - one per core
+    std::size_t threads = 0;
+};
+
+
+// Result of the last scan
+struct ScanStats {
+    std::size_t files = 0;
+    std::size_t directories = 0;
+    std::size_t threads = 0;
+    double seconds = 0;
+
+    // Memory blocks taken by the arenas for temporaries
+    std::size_t arenaBlocks = 0;
+
+    double filesPerSecond() const;
+};
+
+
+// Finds pictures in the directory.
+// In recursive mode subdirectories are handed out to a pool
+// of threads. Pictures are either collected per thread and
+// merged in path order at the end, or streamed in batches.
+// Listing a file allocates nothing of its own: names are read
+// from the listing in place, temporaries of a directory live
+// in an arena of the thread, which is reused for the next one.
+class DirectoryScanner {
+public:
+    // Receives pictures as they are found, from any of the scanning threads.
+    // Returning false stops the scan
+    using BatchCallback = std::function<bool(std::vector<PictureRecord>&&)>;
+
+    // Receives every directory right before it is listed
+    using DirectoryCallback = std::function<void(const std::string&)>;
+
+private:
+    // Receives a batch together with the index of the thread
+    using Sink = std::function<bool(std::size_t, std::vector<PictureRecord>&&)>;
+
+    ScanOptions options;
+    ScanStats stats;
+
+    // Names of the found files go here
+    PictureNames& names;
+
+    // Unchanged directories are restored from here
+    ScanManifest* manifest;
+
+    // Walks the tree, passing batches of at most batchSize pictures to sink
+    void run(const std::string& root, std::size_t batchSize, const Sink& sink,
+                const DirectoryCallback& onDirectory = nullptr);
+
+    // Lists one directory, or restores it from the manifest:
+    // pictures go to sink, subdirectories to subdirectories,
+    // temporaries to arena
+    bool listDirectory(const std::filesystem::path& directory,
+                        std::size_t thread, std::size_t batchSize, const Sink& sink,
+                        std::vector<std::filesystem::path>& subdirectories,
+                        std::pmr::memory_resource& arena) const;
+
+public:
+    DirectoryScanner(PictureNames& names, ScanOptions options = {}, ScanManifest* manifest = nullptr);
+
+    // Records of all pictures under root, ordered by path
+    std::vector<PictureRecord> scan(const std::string& root);
+
+    // Streams pictures under root in order of discovery,
+    // so that the first ones are available long before the end
+    void scan(const std::string& root, const BatchCallback& onBatch, std::size_t batchSize = 64,
+                const DirectoryCallback& onDirectory = nullptr);
+
+    const ScanStats& getStats() const;
+
+    // Checks if given path or file name is a picture
+    static bool isPicture(std::string_view path);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+// C++ standard libraries
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class WatchEventType {
+    ADDED,
+    REMOVED,
+    RENAMED,
+    DIRECTORY_ADDED,
+    DIRECTORY_REMOVED
+};
+
+
+// Change of the folder with pictures
+struct WatchEvent {
+    WatchEventType type;
+    std::string path;
+
+    // Destination for RENAMED
+    std::string newPath;
+};
+
+
+// Reports changes of the folder with pictures (Linux inotify).
+// Only pictures and directories are reported. A picture is
+// ADDED once it is completely written.
+class DirectoryWatcher {
+    int fd;
+    bool recursive;
+
+    // Watched directory of every watch descriptor
+    // Watches are added from the scanning thread
+    std::mutex mutex;
+    std::unordered_map<int, std::string> directories;
+
+    // Raw events waiting to be read
+    std::vector<char> buffer;
+
+public:
+    DirectoryWatcher(bool recursive);
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    // Whether changes can be watched on this system
+    bool isOpen() const;
+
+    // Start watching the directory, may be called from any thread
+    void watch(const std::string& directory);
+
+    // Changes since the last call, never blocks
+    std::vector<WatchEvent> poll();
+
+    ~DirectoryWatcher();
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+// C++ standard libraries
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Groups near duplicates: resized exports, burst shots.
+// Perceptual hashes are found by multi-index hashing: the hash
+// is split into four 16 bit parts, and hashes within 7 bits
+// differ in at most one bit of one of the parts. So every part
+// is looked up together with its 16 one bit neighbours.
+// Groups are kept in a union-find over picture ids.
+class DuplicateIndex {
+    static constexpr int parts = 4;
+    static constexpr int maxDistance = 7;
+
+    // Ids by the value of every part, allocated with the first hash
+    std::array<std::vector<std::vector<std::uint32_t>>, parts> buckets;
+
+    // By id: perceptual hash, parent in the union-find
+    // and size of the group of a representative
+    std::vector<std::uint64_t> hashes;
+    std::vector<std::uint32_t> parents;
+    std::vector<std::uint32_t> sizes;
+
+    // Pictures, that have a near duplicate
+    std::size_t duplicates;
+
+    void unite(std::uint32_t first, std::uint32_t second);
+
+public:
+    DuplicateIndex();
+
+    // Add the picture, and group it with similar ones
+    // Unknown hashes (0) are not grouped
+    void add(std::uint32_t id, std::uint64_t hash);
+
+    // Representative of the group of the picture
+    std::uint32_t find(std::uint32_t id);
+
+    // Whether the pictures look the same
+    bool sameGroup(std::uint32_t first, std::uint32_t second);
+
+    std::size_t getDuplicateCount() const;
+};
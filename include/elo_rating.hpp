@@ -0,0 +1,23 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+
+// Elo rating of pictures.
+// A win over a stronger picture is worth more than
+// a win over a weaker one, so the rating does not depend
+// on how often a picture happens to be drawn.
+class EloRating {
+public:
+    // Rating of a new picture
+    static constexpr double initial = 1500.0;
+
+    // Largest change of a rating by one comparison
+    static constexpr double factor = 32.0;
+
+    // Probability, that the first picture wins
+    static double expected(double rating, double opponent);
+
+    // Apply the result of one comparison, O(1)
+    static void update(PictureRecord& winner, PictureRecord& loser);
+};
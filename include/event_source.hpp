@@ -0,0 +1,93 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// SDL libraries
+#include <SDL2/SDL.h>
+
+// Where menus take their input from: the user, or a recording
+class EventSource {
+public:
+    // Next event of the current frame, false if there are no more
+    virtual bool poll(SDL_Event& event) = 0;
+
+    // The frame is over
+    virtual void endFrame() = 0;
+
+    // Pictures with the ids are shown to be compared
+    virtual void showPair(std::uint32_t first, std::uint32_t second) = 0;
+
+    virtual ~EventSource() = default;
+};
+
+
+// Events of the user. If a path is given, clicks, keys
+// and window events are written there together with the number
+// of the frame they came in and the seed of the session. So are
+// the pairs shown, to check that the replay shows the same ones.
+//
+// The file is a header (magic, seed, size of SDL_Event), then
+// entries of the frame (uint64), the kind (uint8) and either the
+// raw SDL_Event or the ids of a pair (2 x uint32). It is replayed
+// by the same build of SDL only.
+class LiveEventSource : public EventSource {
+    std::ofstream file;
+    std::uint64_t frame;
+
+public:
+    LiveEventSource(const std::string& recordPath = "", std::uint32_t seed = 0);
+
+    virtual bool poll(SDL_Event& event) override;
+
+    virtual void endFrame() override;
+
+    virtual void showPair(std::uint32_t first, std::uint32_t second) override;
+};
+
+
+// Events of a recording, each in the frame it was recorded in.
+// After the last one the session is closed. Pairs shown are
+// compared with the recorded ones, the first one, that differs,
+// is reported
+class ReplayEventSource : public EventSource {
+    struct Entry {
+        std::uint64_t frame;
+        SDL_Event event;
+    };
+
+    std::vector<Entry> entries;
+    std::size_t next;
+
+    // Pairs of the recording, the number shown so far, and
+    // whether the outcome of the check is told already
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    std::size_t shown;
+    bool reported;
+
+    std::uint64_t frame;
+    std::uint32_t seed;
+    bool open;
+
+public:
+    explicit ReplayEventSource(const std::string& path);
+
+    // Whether the recording was read
+    bool isOpen() const;
+
+    // Seed of the recorded session
+    std::uint32_t getSeed() const;
+
+    // Number of recorded events
+    std::size_t size() const;
+
+    virtual bool poll(SDL_Event& event) override;
+
+    virtual void endFrame() override;
+
+    virtual void showPair(std::uint32_t first, std::uint32_t second) override;
+};
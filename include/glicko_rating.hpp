@@ -0,0 +1,69 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Glicko-2 ratings of pictures.
+// Besides the rating every picture has a deviation (how unsure
+// the rating is) and a volatility (how erratic its results are).
+// Comparisons are collected into rating periods of a few votes,
+// then every picture, that took part, is updated at once.
+// Pictures, that were not compared, grow more uncertain.
+class GlickoRating {
+public:
+    // Rating of a new picture, the same scale as Elo
+    static constexpr double initialRating = 1500.0;
+    static constexpr double initialDeviation = 350.0;
+    static constexpr double initialVolatility = 0.06;
+
+private:
+    // Results of a picture in the current period
+    struct Pending {
+        // Sum of g^2 * E * (1 - E), inverse of the variance
+        double information;
+
+        // Sum of g * (score - E)
+        double improvement;
+    };
+
+    // Votes per rating period
+    std::size_t periodLength;
+    std::size_t votes;
+    std::uint32_t period;
+
+    // Pictures compared in this period, by index in pictures
+    std::unordered_map<std::size_t, Pending> pending;
+
+    // Add the result of one game to the picture
+    void add(std::size_t index, const PictureRecord& picture, const PictureRecord& opponent, double score);
+
+    // New volatility (Illinois algorithm from the Glicko-2 paper)
+    static double newVolatility(double phi, double sigma, double variance, double delta);
+
+public:
+    GlickoRating(std::size_t periodLength = 16);
+
+    // Remember the comparison, O(1).
+    // Every periodLength votes the period is closed
+    void record(std::vector<PictureRecord>& pictures, std::size_t winner, std::size_t loser);
+
+    // Update everyone compared in this period.
+    // A period without comparisons is not counted
+    void closePeriod(std::vector<PictureRecord>& pictures);
+
+    // Continue the periods of earlier sessions,
+    // called for every picture loaded
+    void restore(const PictureRecord& picture);
+
+    // Rating, that the picture has with high probability: rating - 2 * deviation
+    static double conservative(const PictureRecord& picture);
+
+    // Probability, that the first picture wins
+    static double expected(const PictureRecord& first, const PictureRecord& second);
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+// Custom libraries
+#include "comparison_schedule.hpp"
+#include "picture_record.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Exact order of pictures by binary insertion sort, where the user
+// is the comparator. Pictures are inserted one by one into the sorted
+// list, each by a binary search of its place, so n pictures take
+// about n * log2(n) votes.
+// The sort is a state machine: the question is the candidate against
+// the middle of the range left, the answer halves the range.
+// The state is saved to sort.json, so the sort goes on next session.
+class InsertionSorter : public ComparisonSchedule {
+    std::string path;
+
+    // Picture ids, best first
+    std::vector<std::uint32_t> sorted;
+
+    // Ids waiting for insertion, the candidate is at the back
+    std::deque<std::uint32_t> pending;
+
+    // Both of the above
+    std::unordered_set<std::uint32_t> known;
+
+    // Range of sorted, where the candidate belongs
+    std::size_t low, high;
+
+    // The state is written only if it changed
+    bool modified;
+
+    void load();
+
+    // Start the search of the next candidate
+    void restart();
+
+    // Insert candidates, whose place is found
+    void settle();
+
+public:
+    // Sort of the folder, an empty path starts a new one, kept in memory
+    InsertionSorter(std::string path);
+
+    // New picture to insert
+    virtual void add(std::uint32_t id) override;
+
+    // The picture is gone, its place is forgotten
+    virtual void remove(std::uint32_t id) override;
+
+    virtual void retain(const std::vector<PictureRecord>& pictures) override;
+
+    // The candidate against the middle of its range, false if all is sorted
+    virtual bool next(std::uint32_t& candidate, std::uint32_t& pivot) const override;
+
+    virtual void answer(bool candidateWins) override;
+
+    // The candidate goes next to the pivot, in no counted order
+    virtual void tie() override;
+
+    virtual bool isDone() const override;
+
+    // Picture ids sorted so far, best first
+    virtual const std::vector<std::uint32_t>& getOrder() const override;
+
+    virtual void save() override;
+};
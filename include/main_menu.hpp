@@ -4,10 +4,22 @@
 #include "base_menu.hpp"
 #include "menu_events.hpp"
 #include "picture_record.hpp"
+#include "picture_names.hpp"
 #include "transition_state.hpp"
+#include "comparison_log.hpp"
+#include "duplicate_index.hpp"
+#include "glicko_rating.hpp"
+#include "pair_history.hpp"
+#include "preference_graph.hpp"
+#include "convergence_tracker.hpp"
+#include "ranking_index.hpp"
+#include "pair_selector.hpp"
+#include "selection_mode.hpp"
+#include "picture_prefetcher.hpp"
 
 // C++ standard libraries
-#include <random>
+#include <functional>
+#include <unordered_map>
 
 // SDL libraries
 #include <SDL2/SDL_ttf.h>
@@ -17,10 +29,46 @@ class MainMenu : public BaseMenu {
 
     // Picture records
     std::vector<PictureRecord>& pictures;
+    const PictureNames& pictureNames;
+
+    // Position of every id in pictures
+    const std::unordered_map<std::uint32_t, std::size_t>& idIndex;
+
+    // History of every matchup
+    ComparisonLog& comparisonLog;
+
+    // Near duplicates are not compared
+    DuplicateIndex& duplicateIndex;
+
+    // Collects votes into rating periods
+    GlickoRating& glickoRating;
+
+    // Pairs are not compared twice, while there are others
+    PairHistory& pairHistory;
+
+    // Pairs, whose order follows from other votes, are not compared
+    PreferenceGraph& preferenceGraph;
+
+    // Learns every vote, to tell whether the ranking still changes
+    ConvergenceTracker& convergenceTracker;
+
+    // Pictures, whose statistics change, are marked there
+    RankingIndex& rankingIndex;
 
     // Current pictures to show
     int currentLeft, currentRight;
 
+    // Next pictures, files are read in advance
+    int nextLeft, nextRight;
+    bool nextChosen;
+    PicturePrefetcher prefetcher;
+
+    // Files of the next pair failed once and are read again
+    bool readRetried;
+
+    // Contents of the files to decode
+    std::vector<unsigned char> leftBytes, rightBytes;
+
     // Pictures
     SDL_Rect leftRect, rightRect;
     SDL_Texture* leftTexture, * rightTexture;
@@ -41,10 +89,16 @@ class MainMenu : public BaseMenu {
     int fontSize;
 
     // Label
+    bool labelShown;
     std::string text;
     SDL_Rect labelRect;
     SDL_Texture* labelTexture;
 
+    // Shown instead of the pictures, while they are not ready
+    std::string loadingText;
+    SDL_Rect loadingRect;
+    SDL_Texture* loadingTexture;
+
     // Counters
     int leftWinner;
     std::string leftCounterText, rightCounterText;
@@ -58,8 +112,18 @@ class MainMenu : public BaseMenu {
     MenuEvent toReturn;
 
     // For choosing pictures
-    std::mt19937 gen;
-    std::uniform_int_distribution<int> dist;
+    SelectionMode selectionMode;
+    PairSelector& pairSelector;
+
+    // Marks a picture, whose file cannot be read, as gone
+    std::function<void(std::size_t)> removePicture;
+
+    // Told of every pair, once it is on the screen
+    std::function<void(std::size_t, std::size_t)> showPair;
+
+    // Files are waited for within the frame, so that
+    // a recorded session takes the same frames every time
+    bool waitForFiles;
 
     // Transition information
     TransitionState transitionState;
@@ -72,10 +136,18 @@ class MainMenu : public BaseMenu {
     // Free texture
     void freeTexture(SDL_Texture** texture);
 
+    // Choose two present pictures, that are not near duplicates
+    // Returns false if there are not enough of them
+    bool choosePair(int& left, int& right);
+
+    // Choose the next pair and start reading its files
+    bool prefetchPair();
+
     // Choose two pictures:
     // - Set the choices to currentLeft and currentRight
     // - Set new textures
-    // - start transition in
+    // - start transition in, or wait if there are no pictures
+    //   or their files are not read yet
     void getRandomDouble(Screen& screen);
 
     // Update windowWidth and windowHeight fields
@@ -124,6 +196,10 @@ class MainMenu : public BaseMenu {
     // Render counters
     void renderCounters(Screen& screen);
 
+    // Update counters, ratings and every index by the vote,
+    // and prefetch the next pair
+    void recordVote(std::size_t winner, std::size_t loser);
+
     // Handle changes when left picture is chosen
     void leftWins();
 
@@ -141,12 +217,19 @@ class MainMenu : public BaseMenu {
     // Handles picture presses
     virtual MenuEvent handleSpecificEvent(const SDL_Event& event, Screen& screen) override; 
 public:
-    MainMenu(Screen& screen, std::vector<PictureRecord>& pictures, std::string& pathToFont);
+    MainMenu(Screen& screen, std::vector<PictureRecord>& pictures, const PictureNames& pictureNames,
+                const std::unordered_map<std::uint32_t, std::size_t>& idIndex, ComparisonLog& comparisonLog, DuplicateIndex& duplicateIndex,
+                GlickoRating& glickoRating, PairHistory& pairHistory,
+                PreferenceGraph& preferenceGraph, ConvergenceTracker& convergenceTracker,
+                RankingIndex& rankingIndex, PairSelector& pairSelector,
+                std::function<void(std::size_t)> removePicture,
+                std::function<void(std::size_t, std::size_t)> showPair, SelectionMode selectionMode,
+                std::string& pathToFont, bool waitForFiles = false);
 
     // If the toReturn value is set to exit,
     // the menu signals it to the application immediately
     // after update
-    virtual MenuEvent handleEvents(Screen& screen) override;
+    virtual MenuEvent handleEvents(Screen& screen, EventSource& events) override;
 
     // Flag if the application has to update and render the menu
     virtual bool toUpdate() override;
@@ -0,0 +1,47 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pairs of pictures compared before, so they are not shown again.
+// A split block Bloom filter: a pair sets one bit in each of the
+// eight words of a single 64 byte block, so a lookup touches one
+// cache line. About 10 bits per pair, roughly 1% false positives.
+// Memory is bounded: once a generation holds its capacity of pairs,
+// it becomes the previous one and the oldest pairs are forgotten.
+class PairHistory {
+    struct alignas(64) Block {
+        std::uint64_t words[8];
+    };
+
+    // Pairs per generation
+    std::size_t capacity;
+
+    // Pairs added to the current generation
+    std::size_t count;
+
+    std::vector<Block> current;
+    std::vector<Block> previous;
+
+    // Same value for both orders of the pair
+    static std::uint64_t key(std::uint32_t first, std::uint32_t second);
+
+    // Whether all bits of the key are set in the filter
+    bool test(const std::vector<Block>& blocks, std::uint64_t hash) const;
+
+public:
+    static constexpr std::size_t minCapacity = 1 << 16;
+    static constexpr std::size_t maxCapacity = 1 << 24;
+
+    PairHistory(std::size_t capacity = minCapacity);
+
+    // Remember the pair of picture ids
+    void insert(std::uint32_t first, std::uint32_t second);
+
+    // Whether the pair was probably compared
+    bool contains(std::uint32_t first, std::uint32_t second) const;
+
+    std::size_t getCapacity() const;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Strategy of choosing two pictures to compare
+class PairSelector {
+public:
+    // Whether the pair may be shown: both present, not duplicates...
+    using Filter = std::function<bool(std::size_t, std::size_t)>;
+
+    // Choose two pictures, that pass the filter.
+    // Returns false if there are none
+    virtual bool choose(const std::vector<PictureRecord>& pictures, const Filter& accept,
+                            std::size_t& left, std::size_t& right) = 0;
+
+    // Learn the result of a comparison,
+    // after ratings of both pictures are updated
+    virtual void record(const std::vector<PictureRecord>&, std::size_t, std::size_t) {}
+
+    virtual ~PairSelector() = default;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstdint>
+
+// Difference hash (dHash) of a picture.
+// The picture is shrunk to 9x8 cells of average brightness,
+// every bit tells whether a cell is darker than its right
+// neighbour. Resized, recompressed or slightly edited copies
+// get hashes, that differ in a few bits only.
+class PerceptualHash {
+public:
+    // Hash of RGBA32 pixels, 0 if the picture is too small
+    static std::uint64_t ofPixels(const unsigned char* pixels, int width, int height, int pitch);
+
+    // Number of different bits
+    static int distance(std::uint64_t first, std::uint64_t second);
+};
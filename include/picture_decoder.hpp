@@ -0,0 +1,23 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstdint>
+#include <vector>
+
+// SDL libraries
+#include <SDL2/SDL.h>
+
+// Decodes pictures for the menus and the hasher threads.
+// Once initialize() loaded the format libraries, several
+// threads decode at once
+class PictureDecoder {
+public:
+    // Load every format library of SDL_image, before any thread decodes
+    static void initialize();
+
+    // Picture from the contents of its file, nullptr if it cannot be decoded
+    static SDL_Surface* decode(const std::vector<unsigned char>& bytes);
+
+    // Perceptual hash from the contents of the file, 0 if it cannot be decoded
+    static std::uint64_t perceptualHash(const std::vector<unsigned char>& bytes);
+};
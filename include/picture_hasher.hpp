@@ -0,0 +1,43 @@
+#pragma once
+
+// Custom libraries
+#include "batched_io.hpp"
+#include "picture_record.hpp"
+#include "picture_names.hpp"
+#include "scan_manifest.hpp"
+
+// C++ standard libraries
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Assigns content hashes to picture records.
+// Hashes are cached in the manifest by (path, size, mtime),
+// so an unchanged file costs only a (batched) stat. Files that are new
+// or changed are hashed in parallel on all cores.
+class PictureHasher {
+public:
+    // Computes perceptual hash from the contents of the file, 0 if it cannot
+    using PerceptualHasher = std::function<std::uint64_t(const std::vector<unsigned char>&)>;
+
+private:
+    const PictureNames& names;
+    ScanManifest& manifest;
+
+    // Decodes the pictures, may be empty
+    PerceptualHasher perceptualHasher;
+
+    // Files of a batch are checked at once
+    BatchedIo io;
+
+public:
+    PictureHasher(const PictureNames& names, ScanManifest& manifest, PerceptualHasher perceptualHasher = nullptr);
+
+    // Fill hash and perceptual hash of every record without one
+    // Records of unreadable files get hash 0
+    void hash(std::vector<PictureRecord>& pictures);
+
+    // Persist the cache
+    void save();
+};
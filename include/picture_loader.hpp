@@ -0,0 +1,97 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+#include "picture_names.hpp"
+#include "data_handler.hpp"
+#include "picture_hasher.hpp"
+#include "directory_scanner.hpp"
+#include "directory_watcher.hpp"
+#include "scan_manifest.hpp"
+
+// C++ standard libraries
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Discovers pictures in the background.
+// One thread scans the folder, another one hashes the found
+// pictures and fills their statistics. The application takes
+// the ready records every frame, so the first pair can be shown
+// long before the whole folder is processed.
+// Both threads stay alive for pictures added later.
+class PictureLoader {
+    std::string pathToPictures;
+    ScanOptions scanOptions;
+
+    // Names of the found files go here
+    PictureNames& names;
+
+    // Used only by the loader while it is running
+    DataHandler& dataHandler;
+    PictureHasher& pictureHasher;
+
+    // Unchanged directories are not listed
+    ScanManifest& manifest;
+
+    // Every scanned directory is watched, if present
+    DirectoryWatcher* watcher;
+
+    std::thread scanThread, processThread;
+    std::atomic<bool> stopping, finished;
+
+    // Guards the queues below
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    // Directories to scan after the initial scan
+    std::deque<std::string> directories;
+
+    // Found by the scanner, waiting for hashing
+    std::deque<std::vector<PictureRecord>> discovered;
+    bool scanFinished;
+
+    // Hashed and filled, waiting for the application
+    std::mutex readyMutex;
+    std::vector<PictureRecord> ready;
+
+    // Thread bodies
+    void scan();
+    void process();
+
+    // Scan the directory, passing the found pictures for hashing
+    void scanDirectory(DirectoryScanner& scanner, const std::string& directory);
+
+public:
+    PictureLoader(std::string pathToPictures, ScanOptions scanOptions, PictureNames& names,
+                    DataHandler& dataHandler, PictureHasher& pictureHasher,
+                    ScanManifest& manifest, DirectoryWatcher* watcher = nullptr);
+
+    PictureLoader(const PictureLoader&) = delete;
+    PictureLoader& operator=(const PictureLoader&) = delete;
+
+    // Run the threads
+    void start();
+
+    // Hash and fill the given records
+    void add(std::vector<PictureRecord>&& pictures);
+
+    // Scan a directory, that appeared after the start
+    void addDirectory(const std::string& directory);
+
+    // Move ready records to the end of pictures.
+    // Returns whether anything was added
+    bool receive(std::vector<PictureRecord>& pictures);
+
+    // The initial scan is complete and processed
+    bool isFinished() const;
+
+    // Interrupt loading and wait for the threads
+    void stop();
+
+    ~PictureLoader();
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Names and directories of all picture files, kept apart from the
+// records, so that loops over the counters do not drag strings along.
+// Every directory is stored once, under an id, and a file keeps only
+// its name and the id: a file costs its name and 24 bytes, the
+// directory is not repeated in every path. Names and directories are
+// stored in blocks, that never move, so they are views without a copy.
+// A path is the two joined, built where a file is opened.
+// A removed file (renamed, for one) frees its handle and the bytes of
+// its name for the next file, views of its name are invalid then.
+// Used by scanning and hashing threads at once.
+class PictureNames {
+    struct Entry {
+        const char* name;
+        std::uint32_t size;
+
+        // Bytes taken, the name may be shorter
+        std::uint32_t capacity;
+
+        std::uint32_t directory;
+    };
+
+    // Block size, longer strings get a block of their own
+    static constexpr std::size_t blockSize = 64 * 1024;
+
+    // Guards only the tables, strings are read outside
+    mutable std::mutex mutex;
+
+    // Storage of strings, the free bytes of the current block
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* next;
+    std::size_t blockLeft;
+
+    std::vector<Entry> entries;
+
+    // Interned directories, never freed
+    std::vector<std::string_view> directories;
+    std::unordered_map<std::string_view, std::uint32_t> directoryIds;
+
+    // Handles and name bytes of removed files, bytes by their size
+    std::vector<std::uint32_t> freeHandles;
+    std::multimap<std::uint32_t, char*> freeBytes;
+
+    // Bytes for a string of the size
+    char* allocate(std::uint32_t size, std::uint32_t& capacity);
+
+    // Id of the directory, stored if it is new
+    std::uint32_t intern(std::string_view directory);
+
+    Entry getEntry(std::uint32_t file) const;
+
+public:
+    PictureNames();
+
+    PictureNames(const PictureNames&) = delete;
+    PictureNames& operator=(const PictureNames&) = delete;
+
+    // Handle of a new file in the directory, which may be empty
+    std::uint32_t add(std::string_view directory, std::string_view name);
+
+    // Handle of a new file, split at the last slash
+    std::uint32_t add(std::string_view path);
+
+    // The handle is not used anymore. Only the UI thread removes files,
+    // and only ones it received: the loader and the hashing threads are
+    // done with them, and copy the paths they work on
+    void remove(std::uint32_t file);
+
+    std::string_view getName(std::uint32_t file) const;
+    std::string_view getDirectory(std::uint32_t file) const;
+
+    // Directory and name joined
+    std::string getPath(std::uint32_t file) const;
+
+    // Number of files
+    std::size_t size() const;
+};
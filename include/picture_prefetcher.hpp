@@ -0,0 +1,80 @@
+#pragma once
+
+// Custom libraries
+#include "batched_io.hpp"
+
+// C++ standard libraries
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class PrefetchStatus {
+    // Not requested, or forgotten to make room
+    NONE,
+    PENDING,
+    READY,
+    FAILED
+};
+
+
+// Reads picture files ahead of time on its own thread,
+// so that they are decoded from memory without waiting
+// for the disk. Requests are read in batches, buffers
+// are passed back and forth and reused.
+class PicturePrefetcher {
+    struct Entry {
+        std::uint64_t id;
+        std::string path;
+        std::vector<unsigned char> data;
+        PrefetchStatus status;
+
+        // Taken by the reading thread
+        bool reading;
+    };
+
+    BatchedIo io;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    // Requested files, that are not taken yet.
+    // The oldest ones are dropped above the limit
+    std::deque<Entry> entries;
+    std::size_t limit;
+    std::uint64_t nextId;
+
+    // Buffers to read into
+    std::vector<std::vector<unsigned char>> spare;
+
+    bool stopping;
+
+    void work();
+
+public:
+    PicturePrefetcher(std::size_t limit = 8);
+
+    PicturePrefetcher(const PicturePrefetcher&) = delete;
+    PicturePrefetcher& operator=(const PicturePrefetcher&) = delete;
+
+    // Start reading the file. A file, that failed, is read again
+    void request(std::string_view path);
+
+    // State of the file
+    PrefetchStatus getStatus(std::string_view path);
+
+    // Block until the requested file is read
+    void wait(std::string_view path);
+
+    // Swap contents of the read file into data.
+    // The previous contents of data are reused for next reads.
+    // The file is forgotten, also if it failed
+    bool take(std::string_view path, std::vector<unsigned char>& data);
+
+    ~PicturePrefetcher();
+};
@@ -1,10 +1,44 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
 
+// Statistics of a picture, 72 bytes of plain data. Records are one
+// array, not a column per field: a vote reads and writes most fields
+// of two pictures, which is 25% faster in one array (rank-bench-records,
+// 1M pictures: 97 ns a vote, 130 ns with columns). Only loading, saving
+// and opening the rank menu read a field of every picture, which
+// columns would make faster (8 ms for all, 3 ms with columns).
 struct PictureRecord {
-    std::string name;
-    std::size_t wins;
-    std::size_t total;
-    std::string path;
+    // Name and directory of the file, see PictureNames
+    std::uint32_t file = 0;
+
+    std::uint32_t wins = 0;
+    std::uint32_t total = 0;
+
+    // Stable identifier, used in the comparison log
+    std::uint32_t id = 0;
+
+    // Hash of the file contents: statistics follow the content,
+    // not the name of the file
+    std::uint64_t hash = 0;
+
+    // Hash of how the picture looks, 0 if unknown.
+    // Near duplicates differ in a few bits
+    std::uint64_t perceptual = 0;
+
+    // File is gone while the app is running.
+    // The record stays for its statistics
+    bool removed = false;
+
+    // Last Glicko rating period, the picture was compared in,
+    // 0 if never. Periods count on across sessions
+    std::uint32_t period = 0;
+
+    // Elo rating, see EloRating
+    double elo = 1500.0;
+
+    // Glicko-2 rating, its deviation and volatility, see GlickoRating
+    double glicko = 1500.0;
+    double deviation = 350.0;
+    double volatility = 0.06;
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+// C++ standard libraries
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// What the votes already tell: if A beat B and B beat C, A is better
+// than C without asking. The transitive closure of the votes is kept
+// as bitset rows, updated with every vote: everything better than the
+// winner becomes better than everything the loser beats.
+// Rows are OR-ed with SIMD, 8192 pictures take 16 MB, pictures with
+// larger ids are left out.
+// Votes, that close a cycle (A > B > C > A), are inconsistent. Pictures
+// of a cycle form a strongly connected component, every one is better
+// and worse than every other one. Such pairs are not implied, and the
+// votes along the cycle are asked again.
+// Votes of earlier sessions are replayed on a thread of its own.
+// Until it is done nothing is implied, and new votes wait.
+class PreferenceGraph {
+    static constexpr std::size_t maxPictures = 8192;
+
+    // Pairs of a cycle waiting to be asked again
+    static constexpr std::size_t maxContradictions = 64;
+
+    // Bits and 64 bit words in a row, rows grow with ids
+    std::size_t capacity;
+    std::size_t words;
+
+    // Row of a: pictures worse than a, and better than a
+    std::vector<std::uint64_t> worse;
+    std::vector<std::uint64_t> better;
+
+    // Losers of every picture's votes
+    std::vector<std::vector<std::uint32_t>> beaten;
+
+    // Winner and loser of votes to repeat
+    std::deque<std::pair<std::uint32_t, std::uint32_t>> contradictions;
+
+    // Replays the votes of earlier sessions
+    std::thread loader;
+
+    // Guards waiting, until loaded
+    std::mutex mutex;
+    std::atomic<bool> loaded;
+
+    // Votes of this session made while loading
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> waiting;
+
+    // Make rows hold the id
+    void reserve(std::uint32_t id);
+
+    static bool test(const std::uint64_t* row, std::uint32_t id);
+
+    // destination |= source
+    static void orRow(std::uint64_t* destination, const std::uint64_t* source, std::size_t words);
+
+    // Queue the votes of a shortest cycle through the new vote
+    void findCycle(std::uint32_t winner, std::uint32_t loser);
+
+    // Add the vote to the closure. Cycles of earlier sessions
+    // were asked again already, so only new ones are queued
+    void add(std::uint32_t winner, std::uint32_t loser, bool queueCycles);
+
+    // Build the closure of the votes, then take the waiting ones
+    void replay(std::vector<std::pair<std::uint32_t, std::uint32_t>> votes);
+
+public:
+    PreferenceGraph();
+
+    PreferenceGraph(const PreferenceGraph&) = delete;
+    PreferenceGraph& operator=(const PreferenceGraph&) = delete;
+
+    // Replay votes of earlier sessions, winner and loser,
+    // in the background
+    void load(std::vector<std::pair<std::uint32_t, std::uint32_t>> votes);
+
+    // Block until the votes of earlier sessions are in
+    void wait();
+
+    // Vote of this session
+    void record(std::uint32_t winner, std::uint32_t loser);
+
+    // Whether the order of the pair follows from the votes,
+    // and was never contradicted
+    bool implies(std::uint32_t first, std::uint32_t second) const;
+
+    // Whether both are better than each other through some votes
+    bool contradicts(std::uint32_t first, std::uint32_t second) const;
+
+    // Next pair of an inconsistent cycle to ask again.
+    // Returns false if there is none
+    bool takeContradiction(std::uint32_t& first, std::uint32_t& second);
+
+    ~PreferenceGraph();
+};
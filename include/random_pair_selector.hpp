@@ -0,0 +1,33 @@
+#pragma once
+
+// Custom libraries
+#include "pair_selector.hpp"
+#include "weighted_sampler.hpp"
+
+// C++ standard libraries
+#include <cstdint>
+#include <random>
+
+// Two random pictures. Pictures with fewer votes are drawn more often,
+// weight of a picture is inverse to its number of comparisons
+class RandomPairSelector : public PairSelector {
+    std::mt19937 gen;
+
+    WeightedSampler sampler;
+
+    static double weight(const PictureRecord& picture);
+
+    // Add pictures, that appeared since the last call
+    void synchronize(const std::vector<PictureRecord>& pictures);
+
+    // Draw a present picture, pictures.size() if there is none
+    std::size_t draw(const std::vector<PictureRecord>& pictures);
+
+public:
+    RandomPairSelector(std::uint32_t seed = std::random_device()());
+
+    virtual bool choose(const std::vector<PictureRecord>& pictures, const Filter& accept,
+                            std::size_t& left, std::size_t& right) override;
+
+    virtual void record(const std::vector<PictureRecord>& pictures, std::size_t winner, std::size_t loser) override;
+};
@@ -6,6 +6,14 @@
 #include "screen.hpp"
 #include "transition_state.hpp"
 #include "picture_record.hpp"
+#include "picture_names.hpp"
+#include "sort_key.hpp"
+#include "convergence_tracker.hpp"
+#include "picture_prefetcher.hpp"
+
+// C++ standard libraries
+#include <cstdint>
+#include <vector>
 
 // SDL libraries
 #include <SDL2/SDL.h>
@@ -13,10 +21,18 @@
 #include <SDL_render.h>
 
 class RankMenu : public BaseMenu {
-    // Pictures
-    std::vector<PictureRecord>& pictures;
+    // Pictures, and their positions in the order of the key
+    const std::vector<PictureRecord>& pictures;
+    const PictureNames& pictureNames;
+    std::vector<std::uint32_t> order;
     int index;
 
+    // Order of pictures, TAB changes it
+    SortKey& sortKey;
+
+    // Whether the ranking still changes
+    const ConvergenceTracker& convergenceTracker;
+
 
     // Labels //
 
@@ -49,10 +65,28 @@ class RankMenu : public BaseMenu {
     std::string totalText;
     SDL_Texture* totalTexture;
 
+    // Rating
+    SDL_Rect ratingRect;
+    std::string ratingText;
+    SDL_Texture* ratingTexture;
+
+    // Convergence of the whole ranking
+    SDL_Rect convergenceRect;
+    std::string convergenceText;
+    SDL_Texture* convergenceTexture;
+
     // Picture
     SDL_Texture* pictureTexture;
     SDL_Rect pictureRect;
 
+    // Files of the shown picture and its neighbours are read ahead,
+    // so that moving left or right does not wait for the disk
+    PicturePrefetcher prefetcher;
+    std::vector<unsigned char> pictureBytes;
+
+    // The picture is shown, or its file cannot be read
+    bool pictureLoaded;
+
     // Technical details //
 
     // Borders
@@ -67,6 +101,18 @@ class RankMenu : public BaseMenu {
     // Return value
     MenuEvent toReturn;
 
+    // Picture at the index of the order
+    const PictureRecord& getPicture() const;
+
+    // Nearest present picture in the direction (-1 or 1), -1 if none
+    int getNeighbour(int step) const;
+
+    // Request files of the picture and both its neighbours
+    void prefetchAround();
+
+    // Make the texture, once the file is read
+    void receivePicture(Screen& screen);
+
     // Loads all textures
     void loadEntities(Screen& screen);
     void loadName(Screen& screen);      // name texture
@@ -75,6 +121,8 @@ class RankMenu : public BaseMenu {
     void loadWins(Screen& screen);      // wins texture
     void loadWinrate(Screen& screen);   // winrate texture
     void loadTotal(Screen& screen);     // total texture
+    void loadRating(Screen& screen);    // rating texture
+    void loadConvergence(Screen& screen);   // convergence texture, once
 
     // Used for loading any label
     void loadLabel(Screen& screen, SDL_Texture** tempTexture, const std::string& toShow);
@@ -126,11 +174,14 @@ class RankMenu : public BaseMenu {
 
     // Handle menu-specific events:
     // - SPACE key 
+    // - TAB key, to change the order
     virtual MenuEvent handleSpecificEvent(const SDL_Event& event, Screen& screen) override;
 public:
-    RankMenu(Screen& screen, std::vector<PictureRecord>& pictures, std::string pathToFont);
+    RankMenu(Screen& screen, const std::vector<PictureRecord>& pictures, const PictureNames& pictureNames,
+                std::vector<std::uint32_t> order, SortKey& sortKey,
+                const ConvergenceTracker& convergenceTracker, std::string pathToFont);
 
-    virtual MenuEvent handleEvents(Screen& screen) override;
+    virtual MenuEvent handleEvents(Screen& screen, EventSource& events) override;
 
     virtual bool toUpdate() override;
 
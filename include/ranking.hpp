@@ -0,0 +1,34 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+#include "sort_key.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <string>
+
+// Scores of pictures for the rank menu by the chosen key
+class Ranking {
+public:
+    // Number of sort keys with a score. SORT and TOP are not:
+    // their orders come from the votes of the sort and top modes
+    static constexpr std::size_t keyCount = 5;
+
+    // Larger is better
+    static double score(const PictureRecord& picture, SortKey key);
+
+    // Lower bound of the 95% Wilson interval of the winrate:
+    // 3 wins of 3 rank below 90 of 100
+    static double wilson(std::size_t wins, std::size_t total);
+
+    // Winrate, as if every picture started with a few votes
+    // won half of the time: few votes keep it close to 50%
+    static double bayes(std::size_t wins, std::size_t total);
+
+    // For labels
+    static std::string name(SortKey key);
+
+    // The key after this one, keys go round
+    static SortKey next(SortKey key);
+};
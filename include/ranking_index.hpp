@@ -0,0 +1,43 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+#include "ranking.hpp"
+#include "sort_key.hpp"
+
+// C++ standard libraries
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every sort key has its order ready, so the rank menu never sorts.
+// Orders are permutations of positions in pictures, which never move.
+// Pictures, whose statistics changed (a vote, removal, arrival), are
+// marked, and only they are put to their new places: the rest of the
+// order is merged with them in O(n), 16 bytes per picture.
+class RankingIndex {
+    struct Entry {
+        double score;
+        std::uint32_t index;
+        bool removed;
+
+        // Removed last, then the best first, then by position
+        bool operator<(const Entry& other) const;
+    };
+
+    std::array<std::vector<Entry>, Ranking::keyCount> orders;
+
+    // Positions in pictures, that changed since the last refresh
+    std::vector<std::size_t> changed;
+
+public:
+    // The picture at the position changed, or appeared
+    void touch(std::size_t index);
+
+    // Put changed pictures to their places
+    void refresh(const std::vector<PictureRecord>& pictures);
+
+    // Positions of pictures by the key, best first, removed last
+    void getOrder(SortKey key, std::vector<std::uint32_t>& order) const;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+// Custom libraries
+#include "picture_record.hpp"
+#include "picture_names.hpp"
+
+// C++ standard libraries
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// What is known about the folder since the last run.
+// A directory, whose mtime did not change, has the same entries,
+// so its pictures are restored from here without listing it.
+// Files are cached by (path, size, mtime) with their content hash
+// and perceptual hash. Restored files are still checked against
+// their size and mtime, a file edited in place does not change
+// the mtime of its directory. Files, that were not hashed before
+// the save, are still listed, and are hashed by the next run.
+class ScanManifest {
+public:
+    struct FileEntry {
+        std::uint64_t size;
+        std::int64_t mtime;     // nanoseconds
+        std::uint64_t hash;
+        std::uint64_t perceptual;
+    };
+
+private:
+    // Names are kept in one string each, every name ends with '\0'
+    struct DirectoryEntry {
+        std::int64_t mtime;
+        std::string subdirectories;
+
+        // Names of pictures
+        std::string files;
+    };
+
+    std::string path;
+
+    // Used by scanning and hashing threads at once
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, DirectoryEntry> directories;
+    std::unordered_map<std::string, FileEntry> files;
+
+    // Directories seen in this run, others are dropped on save
+    std::unordered_set<std::string> visited;
+
+    // Manifest is written only if something changed
+    bool modified;
+
+    void load();
+
+public:
+    ScanManifest(std::string path);
+
+    // If the directory has not changed, fill pictures and subdirectories
+    // from the manifest, adding the files to names. Hashes are left
+    // to PictureHasher, which checks the files. Returns false if it has to be listed
+    bool restore(const std::string& directory, std::int64_t mtime, PictureNames& names,
+                    std::vector<PictureRecord>& pictures, std::vector<std::string>& subdirectories);
+
+    // Remember the listing of the directory,
+    // names of subdirectories and pictures each end with '\0'
+    void updateDirectory(const std::string& directory, std::int64_t mtime,
+                            std::string_view subdirectories, std::string_view pictures);
+
+    // Cached information about the file
+    bool findFile(const std::string& filePath, FileEntry& entry) const;
+
+    void updateFile(const std::string& filePath, const FileEntry& entry);
+
+    // Persist the manifest
+    void save();
+
+    // Modification time of a file or directory in nanoseconds, -1 if absent
+    static std::int64_t modificationTime(const std::string& path);
+};
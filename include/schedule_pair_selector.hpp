@@ -0,0 +1,36 @@
+#pragma once
+
+// Custom libraries
+#include "pair_selector.hpp"
+#include "random_pair_selector.hpp"
+#include "comparison_schedule.hpp"
+
+// C++ standard libraries
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+
+// Asks the questions of a comparison schedule (sort, tournament).
+// Once it has none, pairs are chosen as in the random mode
+class SchedulePairSelector : public PairSelector {
+    ComparisonSchedule& schedule;
+
+    // Chooses pairs when the schedule has no question
+    RandomPairSelector random;
+
+    std::mt19937 gen;
+
+    // Position of every picture id in pictures
+    std::unordered_map<std::uint32_t, std::size_t> positions;
+
+    // Add pictures, that appeared since the last call
+    void synchronize(const std::vector<PictureRecord>& pictures);
+
+public:
+    SchedulePairSelector(ComparisonSchedule& schedule, std::uint32_t seed = std::random_device()());
+
+    virtual bool choose(const std::vector<PictureRecord>& pictures, const Filter& accept,
+                            std::size_t& left, std::size_t& right) override;
+
+    virtual void record(const std::vector<PictureRecord>& pictures, std::size_t winner, std::size_t loser) override;
+};
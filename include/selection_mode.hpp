@@ -0,0 +1,7 @@
+#pragma once
+
+enum class SelectionMode {
+    RANDOM,
+    SORT,
+    TOP
+};
\ No newline at end of file
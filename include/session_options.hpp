@@ -0,0 +1,28 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+class ReplayEventSource;
+
+// How the session is driven: by the user, or by a recording.
+// Recorded and replayed sessions see the same pictures in the same
+// order, start without any saved statistics, choose the same pairs,
+// and leave the folder as it was
+struct SessionOptions {
+    // Seed of choosing pairs, random if absent
+    std::optional<std::uint32_t> seed;
+
+    // Input of the user is written here
+    std::string recordPath;
+
+    // Input is read from here instead of the user,
+    // without a window and at full speed
+    std::string replayPath;
+
+    // The recording of replayPath, read before the folder is scanned
+    std::unique_ptr<ReplayEventSource> replay;
+};
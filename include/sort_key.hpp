@@ -0,0 +1,15 @@
+#pragma once
+
+enum class SortKey {
+    WINS,
+    ELO,
+    GLICKO,
+    WILSON,
+    BAYES,
+
+    // Order found by the sort mode, only the pictures placed
+    SORT,
+
+    // Winners of the tournament of the top mode
+    TOP
+};
\ No newline at end of file
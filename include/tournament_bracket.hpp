@@ -0,0 +1,91 @@
+#pragma once
+
+// Custom libraries
+#include "comparison_schedule.hpp"
+#include "picture_record.hpp"
+
+// C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Best K pictures by a knockout tournament, the user is the referee.
+// The bracket is a complete binary tree with pictures in the leaves,
+// every node holds the winner of the match of its children.
+// The root is the best picture. It leaves the bracket, and only the
+// matches it won are replayed, so the next one costs log2(n) votes.
+// The top K take about n + K * log2(n) votes, the rest of the pictures
+// never get far: every one of them lost to a picture still in play.
+// The bracket is saved to tournament.json, and goes on next session.
+class TournamentBracket : public ComparisonSchedule {
+    // Node without a picture
+    static constexpr std::int64_t empty = -1;
+
+    std::string path;
+
+    // Pictures wanted
+    std::size_t count;
+
+    // Leaves of the tree, a power of two, and leaves ever taken
+    std::size_t leaves;
+    std::size_t filled;
+
+    // Winner of every node, 1 is the root, children of i are 2i and 2i+1
+    std::vector<std::int64_t> tree;
+
+    // Nodes, whose match has to be replayed. The deepest go first
+    std::set<std::size_t> dirty;
+
+    // Leaf of every picture in play
+    std::unordered_map<std::uint32_t, std::size_t> slots;
+
+    // The winners, best first
+    std::vector<std::uint32_t> top;
+
+    // All pictures are known, winners may be crowned
+    bool ready;
+
+    // The state is written only if it changed
+    bool modified;
+
+    void load();
+
+    // Twice as many leaves, the old tree becomes the left half
+    void grow();
+
+    // Put the winner into the node, its parent is replayed if it changed
+    void resolve(std::size_t node, std::int64_t winner);
+
+    // Clear the leaf of the picture
+    void vacate(std::uint32_t id);
+
+    // Resolve matches, that need no vote, and crown winners
+    void settle();
+
+public:
+    // Tournament of the folder, an empty path starts a new one, kept in memory
+    TournamentBracket(std::string path, std::size_t count);
+
+    virtual void add(std::uint32_t id) override;
+
+    virtual void remove(std::uint32_t id) override;
+
+    virtual void retain(const std::vector<PictureRecord>& pictures) override;
+
+    virtual bool next(std::uint32_t& first, std::uint32_t& second) const override;
+
+    virtual void answer(bool firstWins) override;
+
+    // The first goes on, the second stays in play for the next places
+    virtual void tie() override;
+
+    virtual bool isDone() const override;
+
+    // Winners so far, best first
+    virtual const std::vector<std::uint32_t>& getOrder() const override;
+
+    virtual void save() override;
+};
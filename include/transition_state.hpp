@@ -11,5 +11,6 @@ enum class TransitionState {
     RIGHT_OUT,
     CHANGE,
     END,
+    WAIT,
     NONE
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+// C++ standard libraries
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// Draws indices with probability proportional to their weights,
+// which change all the time (votes, uncertainty).
+// Weights are kept in a Fenwick tree: changing one, appending one
+// and drawing are all O(log n), nothing is ever rebuilt.
+class WeightedSampler {
+    // Weight of every index
+    std::vector<double> weights;
+
+    // Fenwick tree of weight sums, 1-based
+    std::vector<double> tree;
+
+    // Highest power of two not above the size
+    std::size_t mask;
+
+    // Sum of weights before the index
+    double prefix(std::size_t index) const;
+
+public:
+    WeightedSampler();
+
+    // Replace all weights at once, O(n)
+    void assign(const std::vector<double>& weights);
+
+    // Append an index with the weight
+    void push(double weight);
+
+    void set(std::size_t index, double weight);
+
+    double get(std::size_t index) const;
+
+    double total() const;
+
+    std::size_t size() const;
+
+    // Index, whose weight interval holds the target in [0, total)
+    std::size_t find(double target) const;
+
+    // Random index, size() if all weights are zero
+    std::size_t sample(std::mt19937& gen) const;
+};
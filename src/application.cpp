@@ -6,6 +6,11 @@
 #include "main_menu.hpp"
 #include "rank_menu.hpp"
 #include "picture_record.hpp"
+#include "picture_decoder.hpp"
+#include "random_pair_selector.hpp"
+#include "schedule_pair_selector.hpp"
+#include "insertion_sorter.hpp"
+#include "tournament_bracket.hpp"
 
 // C++ standard libraries
 #include <filesystem>
@@ -14,35 +19,93 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include <random>
+#include <numeric>
 
 
-Application::Application(std::size_t w, std::size_t h, const std::string& pathToPictures, const std::string& pathToFont, std::string pathToBackground) :
+// Recorded and replayed sessions start from nothing and keep nothing
+static bool isDeterministic(const SessionOptions& options) {
+    return !options.recordPath.empty() || !options.replayPath.empty();
+}
+
+
+// Sum of the counters of the votes
+static std::size_t countVotes(const std::vector<PictureRecord>& pictures) {
+    std::size_t total = 0;
+    for (auto& picture : pictures)
+        total += picture.total;
+
+    return total / 2;
+}
+
+
+Application::Application(std::size_t w, std::size_t h, const std::string& pathToPictures, const std::string& pathToFont, std::string pathToBackground, ScanOptions scanOptions, SelectionMode selectionMode, std::size_t topCount, SessionOptions sessionOptions) :
         // Setup a screen
         screen(w, h, "Picture ranking"),
 
         // Setup main paths
         pathToPictures(pathToPictures),
         pathToFont(pathToFont),
-        dataHandler(pathToPictures) {
+        sortKey(SortKey::WINS),
+        selectionMode(selectionMode),
+        dataHandler(isDeterministic(sessionOptions) ? "" : pathToPictures, pictureNames),
+        scanManifest(pathToPictures),
+        pictureHasher(pictureNames, scanManifest, &PictureDecoder::perceptualHash),
+        directoryWatcher(scanOptions.recursive),
+        pictureLoader(pathToPictures, scanOptions, pictureNames, dataHandler, pictureHasher, scanManifest, &directoryWatcher),
+        comparisonLog(isDeterministic(sessionOptions) ? "" : pathToPictures + "/comparisons.bin"),
+        receivedIds(0),
+        scheduleRetained(false),
+        deterministic(isDeterministic(sessionOptions)),
+        replaying(!sessionOptions.replayPath.empty()) {
+
+    // Input and seed come from the recording, if replayed
+    if (replaying) {
+        seed = sessionOptions.replay->getSeed();
+        events = std::move(sessionOptions.replay);
+    }
+    else {
+        seed = sessionOptions.seed.value_or(std::random_device()());
+        events = std::make_unique<LiveEventSource>(sessionOptions.recordPath, seed);
+    }
     
     // Get all the current pictures in the directory //
 
-    pictures.clear();
-    for(auto& entry : std::filesystem::directory_iterator(pathToPictures)) {
-        // If the picture is met - write the record
-        if (isPicture(entry)) {
-            pictures.push_back(PictureRecord{
-                entry.path().filename().string(), 
-                0,
-                0,
-                entry.path().string()
-            });
-        }
-
+    // Recorded and replayed sessions start from nothing, so earlier
+    // sessions do not change, which pairs they see
+    std::string pathToState = deterministic ? "" : pathToPictures;
+
+    if (selectionMode == SelectionMode::SORT)
+        schedule = std::make_unique<InsertionSorter>(pathToState);
+    else if (selectionMode == SelectionMode::TOP)
+        schedule = std::make_unique<TournamentBracket>(pathToState, topCount);
+
+    pairSelector = makePairSelector();
+
+    // Votes refer to pictures by id
+    comparisonLog.setBeforeWrite([this]() { saveNewIds(); });
+
+    // Pairs compared in earlier sessions, or implied by them, are not shown again
+    // The order they imply is found in the background
+    ComparisonLogReader log(deterministic ? "" : pathToPictures + "/comparisons.bin");
+    pairHistory = PairHistory(log.count() * 2);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> votes;
+    votes.reserve(log.count());
+    log.forEach([this, &votes](const Comparison& comparison) {
+        pairHistory.insert(comparison.winner, comparison.loser);
+        votes.emplace_back(comparison.winner, comparison.loser);
+    });
+    preferenceGraph.load(std::move(votes));
+
+    // Pictures arrive while the app is already running,
+    // the hashing threads decode them
+    PictureDecoder::initialize();
+    pictureLoader.start();
+    if (deterministic) {
+        waitForPictures();
+        preferenceGraph.wait();
     }
 
-    dataHandler.getData(pictures);
-
     // Background 
     if (pathToBackground != "")
         screen.setBackground(pathToBackground);
@@ -59,35 +122,85 @@ int Application::run() {
     // For establishing fps limit
     float desiredDelta = 1.0f / 60;
 
+    // Replay is timed
+    std::size_t votesBefore = countVotes(pictures);
+    std::vector<double> frameTimes;
+
     // Main loop
     while (isRunning) {
         // Start timer
         auto start = std::chrono::high_resolution_clock::now();
 
         // Main structure of the app
+        receivePictures();
+        if (!deterministic)
+            watchPictures();
         handleEvents();
         if (currentMenu->toUpdate()) {
             update();
             render();
         }
+        events->endFrame();
 
         // Capture the time
         auto finish = std::chrono::high_resolution_clock::now();
 
         // Calculate the time to sleep
         std::chrono::duration<float> elapsed = finish - start;
-        if (elapsed.count() < desiredDelta) {
+        if (replaying)
+            frameTimes.push_back(std::chrono::duration<double, std::micro>(finish - start).count());
+        else if (elapsed.count() < desiredDelta) {
             std::this_thread::sleep_for(std::chrono::duration<float>(desiredDelta - elapsed.count()));
         }
     }
 
+    if (replaying)
+        reportTiming(countVotes(pictures) - votesBefore, frameTimes);
+
     return 0;
 }
 
 
+void Application::waitForPictures() {
+    while (!pictureLoader.isFinished())
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    // The second call sees nothing new and settles the schedule
+    receivePictures();
+    receivePictures();
+}
+
+
+void Application::reportTiming(std::size_t votes, std::vector<double>& frameTimes) const {
+    if (frameTimes.empty())
+        return;
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    double total = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0);
+
+    std::cout << "Replayed " << votes << " votes in " << frameTimes.size() << " frames, "
+              << total / 1e6 << " s" << std::endl;
+    std::cout << "Frame: mean " << total / frameTimes.size()
+              << " us, median " << frameTimes[frameTimes.size() / 2]
+              << " us, 99% " << frameTimes[frameTimes.size() * 99 / 100]
+              << " us, max " << frameTimes.back() << " us" << std::endl;
+}
+
+
 Application::~Application() {
     // debug();
+    pictureLoader.stop();
+    receivePictures();
+
+    // Recorded and replayed sessions leave the folder as it was
+    if (deterministic)
+        return;
+
+    glickoRating.closePeriod(pictures);
     dataHandler.updateData(pictures);
+    comparisonLog.flush();
+    if (schedule)
+        schedule->save();
 }
 
 
@@ -96,31 +209,93 @@ void Application::switchToMain() {
     currentMenu = std::make_unique<MainMenu>(
         screen,
         pictures,
-        pathToFont
+        pictureNames,
+        idIndex,
+        comparisonLog,
+        duplicateIndex,
+        glickoRating,
+        pairHistory,
+        preferenceGraph,
+        convergenceTracker,
+        rankingIndex,
+        *pairSelector,
+        [this](std::size_t index) { removePicture(index); },
+        [this](std::size_t left, std::size_t right) { events->showPair(pictures[left].id, pictures[right].id); },
+        selectionMode,
+        pathToFont,
+        deterministic
     );
 }
 
 
+std::unique_ptr<PairSelector> Application::makePairSelector() {
+    if (schedule)
+        return std::make_unique<SchedulePairSelector>(*schedule, seed);
+
+    return std::make_unique<RandomPairSelector>(seed);
+}
+
+
 void Application::switchToRank(MenuEvent event) {
-    // Sort picture records
-    std::sort(pictures.begin(), pictures.end(),
-        [](const PictureRecord& first, const PictureRecord& second) {
-            return first.wins > second.wins;
-        }
-    );
+    // Ratings shown are up to date
+    glickoRating.closePeriod(pictures);
+    rankingIndex.refresh(pictures);
+
+    // Pictures stay in place, the menu walks the order.
+    // Orders of the sort and the tournament are shown only in their modes,
+    // once they have pictures
+    std::vector<std::uint32_t> order;
+    getScheduleOrder(sortKey, order);
+    while (order.empty() && (sortKey == SortKey::SORT || sortKey == SortKey::TOP)) {
+        sortKey = Ranking::next(sortKey);
+        getScheduleOrder(sortKey, order);
+    }
+
+    if (order.empty())
+        rankingIndex.getOrder(sortKey, order);
 
     // Switch the view to Rank menu
     currentMenu = std::make_unique<RankMenu>(
         screen,
         pictures,
+        pictureNames,
+        std::move(order),
+        sortKey,
+        convergenceTracker,
         pathToFont
     );
 }
 
 
+void Application::getScheduleOrder(SortKey key, std::vector<std::uint32_t>& order) const {
+    bool ofMode = (key == SortKey::SORT && selectionMode == SelectionMode::SORT) ||
+                  (key == SortKey::TOP && selectionMode == SelectionMode::TOP);
+    if (!schedule || !ofMode)
+        return;
+
+    const std::vector<std::uint32_t>& ids = schedule->getOrder();
+    std::unordered_map<std::uint32_t, std::size_t> places;
+    for (std::size_t place = 0; place < ids.size(); place++)
+        places[ids[place]] = place;
+
+    // Positions by place, pictures, that are gone, are left out
+    std::vector<std::int64_t> positions(ids.size(), -1);
+    for (std::size_t i = 0; i < pictures.size(); i++) {
+        auto found = places.find(pictures[i].id);
+        if (found != places.end() && !pictures[i].removed)
+            positions[found->second] = i;
+    }
+
+    for (auto position : positions) {
+        if (position >= 0)
+            order.push_back(position);
+    }
+}
+
+
 void Application::handleEvents() {
     // Hangle SDL events
-    MenuEvent event = currentMenu->handleEvents(screen);
+    MenuEvent event = currentMenu->handleEvents(screen, *events);
 
     // Communication between menu and app
     switch (event) {
@@ -161,7 +336,7 @@ void Application::render() {
 void Application::debug() const {
     // Show information of each picture record
     for(auto& picture : pictures) {
-        std::cout << "Name: " << picture.name << std::endl;
+        std::cout << "Name: " << pictureNames.getName(picture.file) << std::endl;
         std::cout << "Wins: " << picture.wins << std::endl;
         std::cout << "Total: " << picture.total << std::endl;
         std::cout << "Success rate: " << 1.0f * picture.wins / picture.total << std::endl << std::endl;
@@ -169,11 +344,147 @@ void Application::debug() const {
 }
 
 
-bool Application::isPicture(const std::filesystem::directory_entry& entry) const {
-    return (
-        entry.path().extension().string() == ".jpg" ||
-        entry.path().extension().string() == ".jpeg" ||
-        entry.path().extension().string() == ".png" ||
-        entry.path().extension().string() == ".bmp"
-    );
-}
\ No newline at end of file
+
+void Application::receivePictures() {
+    // Checked first, so the last records are received before
+    bool finished = pictureLoader.isFinished();
+
+    std::size_t first = pictures.size();
+    if (!pictureLoader.receive(pictures)) {
+        // Every picture is known, the ones of the schedule, that did not come back, are dropped
+        if (finished && !scheduleRetained && schedule) {
+            schedule->retain(pictures);
+            scheduleRetained = true;
+        }
+
+        return;
+    }
+
+    // Of identical copies the one with the smallest path is kept,
+    // so the result does not depend on order of discovery
+    std::size_t last = first;
+    for (std::size_t i = first; i < pictures.size(); i++) {
+        PictureRecord& picture = pictures[i];
+
+        // Unreadable file
+        if (picture.hash == 0) {
+            pictureNames.remove(picture.file);
+            continue;
+        }
+
+        // The file is overwritten with other content
+        std::string path(pictureNames.getPath(picture.file));
+        auto samePath = pathIndex.find(path);
+        if (samePath != pathIndex.end() && pictures[samePath->second].hash != picture.hash)
+            removePicture(samePath->second);
+
+        auto [found, inserted] = pictureIndex.try_emplace(picture.hash, last);
+        if (!inserted) {
+            // The content came back, or this copy has smaller path
+            PictureRecord& existing = pictures[found->second];
+            std::string existingPath(pictureNames.getPath(existing.file));
+            if (existing.removed || path < existingPath) {
+                pathIndex.erase(existingPath);
+
+                pictureNames.remove(existing.file);
+                existing.file = picture.file;
+                existing.removed = false;
+                rankingIndex.touch(found->second);
+                convergenceTracker.touch(found->second);
+
+                pathIndex[path] = found->second;
+            }
+            else
+                pictureNames.remove(picture.file);
+            continue;
+        }
+
+        if (i != last)
+            pictures[last] = picture;
+
+        pathIndex[path] = last;
+        idIndex[pictures[last].id] = last;
+        receivedIds = std::max(receivedIds, pictures[last].id + 1);
+        glickoRating.restore(pictures[last]);
+        duplicateIndex.add(pictures[last].id, pictures[last].perceptual);
+        rankingIndex.touch(last);
+        last++;
+    }
+
+    pictures.erase(pictures.begin() + last, pictures.end());
+}
+
+
+void Application::watchPictures() {
+    std::vector<PictureRecord> added;
+
+    for (auto& event : directoryWatcher.poll()) {
+        auto found = pathIndex.find(event.path);
+
+        switch (event.type) {
+            // Hashed in the background, arrives with receivePictures()
+            case WatchEventType::ADDED:
+                added.push_back(PictureRecord{.file = pictureNames.add(event.path)});
+                break;
+
+            case WatchEventType::REMOVED:
+                if (found != pathIndex.end())
+                    removePicture(found->second);
+                break;
+
+            // Same content, so only the location changes
+            case WatchEventType::RENAMED: {
+                // The picture, that was there, is overwritten
+                auto target = pathIndex.find(event.newPath);
+                if (target != pathIndex.end() && (found == pathIndex.end() || target->second != found->second))
+                    removePicture(target->second);
+
+                if (found == pathIndex.end()) {
+                    added.push_back(PictureRecord{.file = pictureNames.add(event.newPath)});
+                }
+                else {
+                    std::size_t index = found->second;
+                    pathIndex.erase(found);
+
+                    pictureNames.remove(pictures[index].file);
+                    pictures[index].file = pictureNames.add(event.newPath);
+                    pathIndex[event.newPath] = index;
+                }
+                break;
+            }
+
+            // Only the new directory is scanned
+            case WatchEventType::DIRECTORY_ADDED:
+                pictureLoader.addDirectory(event.path);
+                break;
+
+            case WatchEventType::DIRECTORY_REMOVED:
+                for (std::size_t i = 0; i < pictures.size(); i++) {
+                    if (!pictures[i].removed && pictureNames.getPath(pictures[i].file).starts_with(event.path + "/"))
+                        removePicture(i);
+                }
+                break;
+        }
+    }
+
+    if (!added.empty())
+        pictureLoader.add(std::move(added));
+}
+
+
+void Application::removePicture(std::size_t index) {
+    pictures[index].removed = true;
+    rankingIndex.touch(index);
+    convergenceTracker.touch(index);
+
+    // The path may belong to another picture already
+    auto found = pathIndex.find(pictureNames.getPath(pictures[index].file));
+    if (found != pathIndex.end() && found->second == index)
+        pathIndex.erase(found);
+}
+
+
+void Application::saveNewIds() {
+    if (receivedIds > dataHandler.getSavedIds())
+        dataHandler.updateData(pictures);
+}
@@ -3,11 +3,11 @@
 // Custom libraries
 #include "menu_events.hpp"
 
-MenuEvent BaseMenu::handleEvents(Screen& screen) {
+MenuEvent BaseMenu::handleEvents(Screen& screen, EventSource& events) {
     // Event type to get queue of events
     SDL_Event event;
 
-    while (SDL_PollEvent(&event)) {
+    while (events.poll(event)) {
         if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_ESCAPE)
             return MenuEvent::EXIT;
 
@@ -0,0 +1,372 @@
+#include "batched_io.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+// POSIX libraries
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+// Linux libraries
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+
+BatchedIo::BatchedIo(unsigned entries) :
+        ringFd(-1),
+        entries(entries),
+        submissionRing(nullptr),
+        completionRing(nullptr),
+        submissionEntries(nullptr),
+        submissionRingSize(0),
+        completionRingSize(0),
+        submissionEntriesSize(0) {
+    setup();
+}
+
+
+bool BatchedIo::isBatched() const {
+    return ringFd != -1;
+}
+
+
+#ifdef __linux__
+
+void BatchedIo::setup() {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    // Refused by old kernels and some sandboxes
+    ringFd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ringFd < 0) {
+        ringFd = -1;
+        return;
+    }
+
+    entries = params.sq_entries;
+
+    // Map the rings //
+
+    submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    // Newer kernels share one mapping for both rings
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+        submissionRingSize = completionRingSize = std::max(submissionRingSize, completionRingSize);
+
+    submissionRing = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+
+    completionRing = single ? submissionRing :
+                    mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+
+    submissionEntries = mmap(nullptr, submissionEntriesSize, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+
+    if (submissionRing == MAP_FAILED || completionRing == MAP_FAILED || submissionEntries == MAP_FAILED) {
+        teardown();
+        return;
+    }
+
+    char* submission = static_cast<char*>(submissionRing);
+    submissionTail = reinterpret_cast<unsigned*>(submission + params.sq_off.tail);
+    submissionMask = reinterpret_cast<unsigned*>(submission + params.sq_off.ring_mask);
+    submissionArray = reinterpret_cast<unsigned*>(submission + params.sq_off.array);
+
+    char* completion = static_cast<char*>(completionRing);
+    completionHead = reinterpret_cast<unsigned*>(completion + params.cq_off.head);
+    completionTail = reinterpret_cast<unsigned*>(completion + params.cq_off.tail);
+    completionMask = reinterpret_cast<unsigned*>(completion + params.cq_off.ring_mask);
+    completionEntries = completion + params.cq_off.cqes;
+}
+
+
+void BatchedIo::teardown() {
+    if (submissionEntries && submissionEntries != MAP_FAILED)
+        munmap(submissionEntries, submissionEntriesSize);
+    if (completionRing && completionRing != MAP_FAILED && completionRing != submissionRing)
+        munmap(completionRing, completionRingSize);
+    if (submissionRing && submissionRing != MAP_FAILED)
+        munmap(submissionRing, submissionRingSize);
+
+    submissionRing = completionRing = submissionEntries = nullptr;
+
+    if (ringFd != -1)
+        close(ringFd);
+    ringFd = -1;
+}
+
+
+void BatchedIo::submitBatch(std::size_t count, const Prepare& prepare, std::vector<std::int32_t>& results) {
+    results.assign(count, -ENOSYS);
+
+    for (std::size_t first = 0; first < count && ringFd != -1; first += entries) {
+        unsigned batch = std::min<std::size_t>(entries, count - first);
+
+        // Queue the operations //
+
+        // Only this thread moves the tail
+        unsigned tail = *submissionTail;
+        for (unsigned i = 0; i < batch; i++) {
+            unsigned slot = (tail + i) & *submissionMask;
+            io_uring_sqe* entry = static_cast<io_uring_sqe*>(submissionEntries) + slot;
+
+            std::memset(entry, 0, sizeof(io_uring_sqe));
+            prepare(first + i, entry);
+            entry->user_data = first + i;
+
+            submissionArray[slot] = slot;
+        }
+        std::atomic_ref(*submissionTail).store(tail + batch, std::memory_order_release);
+
+        // Submit and wait for the whole batch //
+
+        unsigned toSubmit = batch, completed = 0;
+        auto reap = [&]() {
+            unsigned head = *completionHead;
+            unsigned end = std::atomic_ref(*completionTail).load(std::memory_order_acquire);
+            for (; head != end; head++) {
+                const io_uring_cqe* completion =
+                    static_cast<io_uring_cqe*>(completionEntries) + (head & *completionMask);
+
+                results[completion->user_data] = completion->res;
+                completed++;
+            }
+            std::atomic_ref(*completionHead).store(head, std::memory_order_release);
+        };
+
+        bool failed = false;
+        while (completed < batch) {
+            long submitted = syscall(__NR_io_uring_enter, ringFd, toSubmit, batch - completed,
+                                        IORING_ENTER_GETEVENTS, nullptr, 0);
+
+            if (submitted < 0 && errno != EINTR) {
+                failed = true;
+                break;
+            }
+            if (submitted > 0)
+                toSubmit -= submitted;
+
+            reap();
+        }
+
+        if (failed) {
+            // Operations, that the kernel took, may still run. Their results
+            // are waited for, so opened files are closed by the caller and not
+            // opened again, and no read writes into a buffer after return
+            reap();
+            while (completed < batch - toSubmit) {
+                long waited = syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (waited < 0 && errno != EINTR)
+                    break;
+
+                reap();
+            }
+
+            // The rest is done without the ring
+            teardown();
+            return;
+        }
+    }
+}
+
+
+void BatchedIo::stat(const std::vector<std::string>& paths, std::vector<FileStatus>& statuses) {
+    statuses.assign(paths.size(), FileStatus{false, 0, 0});
+
+    std::vector<struct statx> buffers(paths.size());
+    std::vector<std::int32_t> results;
+
+    submitBatch(paths.size(), [&](std::size_t i, void* entry) {
+        io_uring_sqe* submission = static_cast<io_uring_sqe*>(entry);
+        submission->opcode = IORING_OP_STATX;
+        submission->fd = AT_FDCWD;
+        submission->addr = reinterpret_cast<std::uint64_t>(paths[i].c_str());
+        submission->len = STATX_SIZE | STATX_MTIME;
+        submission->off = reinterpret_cast<std::uint64_t>(&buffers[i]);
+    }, results);
+
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        if (results[i] == 0) {
+            statuses[i] = FileStatus{
+                true,
+                buffers[i].stx_size,
+                buffers[i].stx_mtime.tv_sec * 1000000000LL + buffers[i].stx_mtime.tv_nsec
+            };
+            continue;
+        }
+
+        // Not run, or refused by the kernel
+        struct stat info;
+        if (::stat(paths[i].c_str(), &info) == 0)
+            statuses[i] = FileStatus{true, static_cast<std::uint64_t>(info.st_size),
+                                    info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec};
+    }
+}
+
+
+void BatchedIo::read(const std::vector<std::string>& paths,
+                        std::vector<std::vector<unsigned char>>& buffers, std::vector<bool>& succeeded) {
+    buffers.resize(paths.size());
+    succeeded.assign(paths.size(), false);
+
+    std::vector<FileStatus> statuses;
+    stat(paths, statuses);
+
+    std::vector<std::int32_t> results;
+
+    // Open //
+
+    std::vector<int> descriptors(paths.size(), -1);
+    submitBatch(paths.size(), [&](std::size_t i, void* entry) {
+        io_uring_sqe* submission = static_cast<io_uring_sqe*>(entry);
+        submission->opcode = IORING_OP_OPENAT;
+        submission->fd = AT_FDCWD;
+        submission->addr = reinterpret_cast<std::uint64_t>(paths[i].c_str());
+        submission->open_flags = O_RDONLY | O_CLOEXEC;
+    }, results);
+
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        if (results[i] >= 0)
+            descriptors[i] = results[i];
+        else if (statuses[i].exists)
+            descriptors[i] = open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (descriptors[i] != -1)
+            buffers[i].resize(statuses[i].size);
+    }
+
+    // Read //
+
+    submitBatch(paths.size(), [&](std::size_t i, void* entry) {
+        io_uring_sqe* submission = static_cast<io_uring_sqe*>(entry);
+
+        if (descriptors[i] == -1 || buffers[i].empty()) {
+            submission->opcode = IORING_OP_NOP;
+            return;
+        }
+
+        submission->opcode = IORING_OP_READ;
+        submission->fd = descriptors[i];
+        submission->addr = reinterpret_cast<std::uint64_t>(buffers[i].data());
+        submission->len = buffers[i].size();
+        submission->off = 0;
+    }, results);
+
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        if (descriptors[i] == -1)
+            continue;
+
+        // Short reads, and reads without the ring, are finished here
+        std::size_t done = std::max<std::int32_t>(results[i], 0);
+        bool error = false;
+
+        while (done < buffers[i].size()) {
+            ssize_t length = pread(descriptors[i], buffers[i].data() + done, buffers[i].size() - done, done);
+            if (length == -1 && errno == EINTR)
+                continue;
+
+            if (length == -1)
+                error = true;
+
+            // The file was truncated meanwhile
+            if (length <= 0)
+                break;
+
+            done += length;
+        }
+
+        buffers[i].resize(done);
+        succeeded[i] = !error;
+    }
+
+    // Close //
+
+    submitBatch(paths.size(), [&](std::size_t i, void* entry) {
+        io_uring_sqe* submission = static_cast<io_uring_sqe*>(entry);
+
+        if (descriptors[i] == -1) {
+            submission->opcode = IORING_OP_NOP;
+            return;
+        }
+
+        submission->opcode = IORING_OP_CLOSE;
+        submission->fd = descriptors[i];
+    }, results);
+
+    // Not run, or the kernel has no close operation
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        if (descriptors[i] != -1 && (results[i] == -ENOSYS || results[i] == -EINVAL))
+            close(descriptors[i]);
+    }
+}
+
+#else
+
+void BatchedIo::setup() {}
+
+
+void BatchedIo::teardown() {}
+
+
+void BatchedIo::submitBatch(std::size_t count, const Prepare&, std::vector<std::int32_t>& results) {
+    results.assign(count, -ENOSYS);
+}
+
+
+void BatchedIo::stat(const std::vector<std::string>& paths, std::vector<FileStatus>& statuses) {
+    statuses.assign(paths.size(), FileStatus{false, 0, 0});
+
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        struct stat info;
+        if (::stat(paths[i].c_str(), &info) == 0)
+            statuses[i] = FileStatus{true, static_cast<std::uint64_t>(info.st_size),
+                                    static_cast<std::int64_t>(info.st_mtime) * 1000000000LL};
+    }
+}
+
+
+void BatchedIo::read(const std::vector<std::string>& paths,
+                        std::vector<std::vector<unsigned char>>& buffers, std::vector<bool>& succeeded) {
+    buffers.resize(paths.size());
+    succeeded.assign(paths.size(), false);
+
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        struct stat info;
+        int fd = open(paths[i].c_str(), O_RDONLY);
+        if (fd == -1)
+            continue;
+
+        if (fstat(fd, &info) == 0) {
+            buffers[i].resize(info.st_size);
+
+            std::size_t done = 0;
+            ssize_t length;
+            while (done < buffers[i].size() &&
+                    (length = pread(fd, buffers[i].data() + done, buffers[i].size() - done, done)) > 0)
+                done += length;
+
+            buffers[i].resize(done);
+            succeeded[i] = true;
+        }
+
+        close(fd);
+    }
+}
+
+#endif
+
+
+BatchedIo::~BatchedIo() {
+    teardown();
+}
@@ -0,0 +1,227 @@
+#include "bradley_terry.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+
+// Run f(thread, first, last) on ranges of [0, count) on every thread
+template<typename F>
+static void parallelFor(std::size_t count, std::size_t threads, F&& f) {
+    threads = std::max<std::size_t>(1, std::min(threads, count));
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads; t++)
+        workers.emplace_back(f, t, count * t / threads, count * (t + 1) / threads);
+    f(0, 0, count / threads);
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+
+static std::size_t threadCount(std::size_t threads) {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    return std::max<std::size_t>(threads, 1);
+}
+
+
+BradleyTerry::BradleyTerry() :
+        iterations(0),
+        change(0.0) {}
+
+
+template<typename ForEach>
+void BradleyTerry::buildFrom(ForEach&& forEach, std::size_t threads) {
+    threads = threadCount(threads);
+
+    // Count games of every picture //
+
+    std::size_t count = 0;
+    std::vector<std::uint64_t> degrees;
+
+    forEach([&](std::uint32_t winner, std::uint32_t loser) {
+        if (winner == loser)
+            return;
+
+        std::size_t needed = std::max(winner, loser) + 1;
+        if (needed > degrees.size())
+            degrees.resize(needed, 0);
+
+        degrees[winner]++;
+        degrees[loser]++;
+        count = std::max(count, needed);
+    });
+
+    // Every game goes into both rows //
+
+    std::vector<std::uint64_t> rows(count + 1, 0);
+    for (std::size_t i = 0; i < count; i++)
+        rows[i + 1] = rows[i] + degrees[i];
+
+    std::vector<std::uint32_t> all(rows[count]);
+    std::vector<std::uint64_t> filled(rows.begin(), rows.end() - 1);
+
+    forEach([&](std::uint32_t winner, std::uint32_t loser) {
+        if (winner == loser)
+            return;
+
+        // Opponent id, lowest bit tells whether the row picture won
+        all[filled[winner]++] = (loser << 1) | 1;
+        all[filled[loser]++] = winner << 1;
+    });
+
+    filled.clear();
+    filled.shrink_to_fit();
+
+    // Merge repeated opponents, in place and in parallel //
+
+    std::vector<std::uint64_t> unique(count, 0);
+    std::vector<std::uint32_t> counts(all.size());
+    std::vector<std::uint32_t> won(all.size());
+
+    parallelFor(count, threads, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            std::uint32_t* begin = all.data() + rows[i];
+            std::uint32_t* end = all.data() + rows[i + 1];
+            std::sort(begin, end);
+
+            // Losses to an opponent come right before wins over it
+            std::uint32_t* out = begin;
+            std::uint32_t* outCount = counts.data() + rows[i];
+            std::uint32_t* outWon = won.data() + rows[i];
+            for (std::uint32_t* it = begin; it != end; ) {
+                std::uint32_t opponent = *it >> 1;
+                std::uint32_t* next = std::upper_bound(it, end, (opponent << 1) | 1);
+                std::uint32_t* firstWin = std::lower_bound(it, next, (opponent << 1) | 1);
+
+                *out++ = opponent;
+                *outCount++ = next - it;
+                *outWon++ = next - firstWin;
+                it = next;
+            }
+
+            unique[i] = out - begin;
+        }
+    });
+
+    // Compact rows //
+
+    offsets.assign(count + 1, 0);
+    for (std::size_t i = 0; i < count; i++)
+        offsets[i + 1] = offsets[i] + unique[i];
+
+    opponents.resize(offsets[count]);
+    games.resize(offsets[count]);
+    beaten.resize(offsets[count]);
+
+    parallelFor(count, threads, [&](std::size_t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; i++) {
+            std::copy_n(all.data() + rows[i], unique[i], opponents.data() + offsets[i]);
+            std::copy_n(counts.data() + rows[i], unique[i], games.data() + offsets[i]);
+            std::copy_n(won.data() + rows[i], unique[i], beaten.data() + offsets[i]);
+        }
+    });
+
+    strengths.assign(count, 1.0);
+    iterations = 0;
+    change = 0.0;
+}
+
+
+void BradleyTerry::build(const ComparisonLogReader& log, std::size_t threads) {
+    buildFrom([&log](auto&& f) {
+        log.forEach([&f](const Comparison& comparison) { f(comparison.winner, comparison.loser); });
+    }, threads);
+}
+
+
+void BradleyTerry::build(const std::vector<Comparison>& comparisons, std::size_t threads) {
+    buildFrom([&comparisons](auto&& f) {
+        for (const auto& comparison : comparisons)
+            f(comparison.winner, comparison.loser);
+    }, threads);
+}
+
+
+bool BradleyTerry::solve(const BradleyTerryOptions& options) {
+    std::size_t threads = threadCount(options.threads);
+    std::size_t count = strengths.size();
+
+    std::vector<double> next(count);
+    std::vector<double> changes(threads);
+
+    for (iterations = 0; iterations < options.maxIterations; ) {
+        // One step, rows are independent //
+
+        parallelFor(count, threads, [&](std::size_t thread, std::size_t first, std::size_t last) {
+            double largest = 0.0;
+
+            for (std::size_t i = first; i < last; i++) {
+                double p = strengths[i];
+
+                // Virtual win and loss against a picture of strength 1
+                double numerator = options.prior / (p + 1.0);
+                double denominator = options.prior / (p + 1.0);
+
+                for (std::uint64_t k = offsets[i]; k < offsets[i + 1]; k++) {
+                    double q = strengths[opponents[k]];
+                    double weight = 1.0 / (p + q);
+
+                    numerator += beaten[k] * q * weight;
+                    denominator += (games[k] - beaten[k]) * weight;
+                }
+
+                next[i] = numerator / denominator;
+                largest = std::max(largest, std::abs(next[i] - p) / p);
+            }
+
+            changes[thread] = largest;
+        });
+
+        strengths.swap(next);
+        iterations++;
+
+        change = *std::max_element(changes.begin(), changes.end());
+        if (change < options.tolerance)
+            return true;
+    }
+
+    return count == 0;
+}
+
+
+const std::vector<double>& BradleyTerry::getStrengths() const {
+    return strengths;
+}
+
+
+double BradleyTerry::getRating(std::uint32_t id) const {
+    if (id >= strengths.size())
+        return 1500.0;
+
+    return 1500.0 + 400.0 * std::log10(strengths[id]);
+}
+
+
+std::size_t BradleyTerry::getPictureCount() const {
+    return strengths.size();
+}
+
+
+std::size_t BradleyTerry::getPairCount() const {
+    return opponents.size() / 2;
+}
+
+
+std::size_t BradleyTerry::getIterations() const {
+    return iterations;
+}
+
+
+double BradleyTerry::getChange() const {
+    return change;
+}
@@ -0,0 +1,287 @@
+#include "comparison_log.hpp"
+
+// C++ standard libraries
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// POSIX libraries
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// Layout of the chunk header (little-endian)
+static constexpr std::uint32_t chunkMagic = 0x314c4352;    // "RCL1"
+static constexpr std::size_t headerSize = 4 + 4 + 8 + 8 + 4 + 4 + 4;
+
+
+static std::uint64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+
+static std::uint64_t nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+
+static void putVarint(std::string& out, std::uint64_t value) {
+    // 7 bits per byte, high bit means "more bytes follow"
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+
+static bool getVarint(const std::uint8_t*& it, const std::uint8_t* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; it < end && shift < 64; shift += 7) {
+        std::uint8_t byte = *it++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+
+static std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+
+static std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+
+template<typename T>
+static void putRaw(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+
+template<typename T>
+static T getRaw(const std::uint8_t* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+
+ComparisonLog::ComparisonLog(std::string path, std::size_t flushThreshold) :
+        path(path),
+        session(nowNanos()),
+        flushThreshold(flushThreshold) {
+    pending.reserve(flushThreshold);
+}
+
+
+void ComparisonLog::record(std::uint32_t winner, std::uint32_t loser) {
+    pending.push_back(Comparison{winner, loser, nowMillis(), session});
+
+    if (pending.size() >= flushThreshold)
+        flush();
+}
+
+
+void ComparisonLog::flush() {
+    if (pending.empty())
+        return;
+
+    if (path.empty()) {
+        pending.clear();
+        return;
+    }
+
+    if (beforeWrite)
+        beforeWrite();
+
+    // Encode columns separately, so readers can scan only what they need
+    std::string winners, losers, timestamps;
+    std::uint64_t previous = pending.front().timestamp;
+
+    for (const auto& comparison : pending) {
+        putVarint(winners, comparison.winner);
+        putVarint(losers, comparison.loser);
+
+        // Clock may go backwards, hence zigzag
+        putVarint(timestamps, zigzag(static_cast<std::int64_t>(comparison.timestamp - previous)));
+        previous = comparison.timestamp;
+    }
+
+    // Header
+    std::string chunk;
+    chunk.reserve(headerSize + winners.size() + losers.size() + timestamps.size());
+    putRaw<std::uint32_t>(chunk, chunkMagic);
+    putRaw<std::uint32_t>(chunk, pending.size());
+    putRaw<std::uint64_t>(chunk, session);
+    putRaw<std::uint64_t>(chunk, pending.front().timestamp);
+    putRaw<std::uint32_t>(chunk, winners.size());
+    putRaw<std::uint32_t>(chunk, losers.size());
+    putRaw<std::uint32_t>(chunk, timestamps.size());
+
+    // Columns
+    chunk += winners;
+    chunk += losers;
+    chunk += timestamps;
+
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    if (!file.write(chunk.data(), chunk.size())) {
+        std::cout << "Could not write comparisons to " << path << std::endl;
+        return;
+    }
+
+    pending.clear();
+}
+
+
+void ComparisonLog::setBeforeWrite(std::function<void()> hook) {
+    beforeWrite = std::move(hook);
+}
+
+
+std::uint64_t ComparisonLog::getSession() const {
+    return session;
+}
+
+
+ComparisonLog::~ComparisonLog() {
+    flush();
+}
+
+
+ComparisonLogReader::ComparisonLogReader(const std::string& path) :
+        fd(-1),
+        data(nullptr),
+        size(0) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || info.st_size == 0)
+        return;
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+        return;
+
+    // The log is decoded front to back
+    madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+    data = static_cast<const std::uint8_t*>(mapped);
+    size = info.st_size;
+}
+
+
+bool ComparisonLogReader::isOpen() const {
+    return data != nullptr;
+}
+
+
+std::size_t ComparisonLogReader::decodeChunk(std::size_t offset, std::vector<Comparison>& buffer) const {
+    buffer.clear();
+
+    // Truncated or foreign data ends the log
+    if (size - offset < headerSize || getRaw<std::uint32_t>(data + offset) != chunkMagic)
+        return 0;
+
+    const std::uint8_t* header = data + offset;
+    std::uint32_t count         = getRaw<std::uint32_t>(header + 4);
+    std::uint64_t session       = getRaw<std::uint64_t>(header + 8);
+    std::uint64_t timestamp     = getRaw<std::uint64_t>(header + 16);
+    std::size_t winnersBytes    = getRaw<std::uint32_t>(header + 24);
+    std::size_t losersBytes     = getRaw<std::uint32_t>(header + 28);
+    std::size_t timestampsBytes = getRaw<std::uint32_t>(header + 32);
+
+    std::size_t end = offset + headerSize + winnersBytes + losersBytes + timestampsBytes;
+    if (end > size)
+        return 0;
+
+    // Column cursors
+    const std::uint8_t* winners = header + headerSize;
+    const std::uint8_t* losers = winners + winnersBytes;
+    const std::uint8_t* timestamps = losers + losersBytes;
+    const std::uint8_t* timestampsEnd = timestamps + timestampsBytes;
+
+    buffer.reserve(count);
+    for (std::uint32_t i = 0; i < count; i++) {
+        std::uint64_t winner, loser, delta;
+
+        if (!getVarint(winners, losers, winner) ||
+                !getVarint(losers, timestamps, loser) ||
+                !getVarint(timestamps, timestampsEnd, delta)) {
+            buffer.clear();
+            return 0;
+        }
+
+        timestamp += unzigzag(delta);
+        buffer.push_back(Comparison{
+            static_cast<std::uint32_t>(winner),
+            static_cast<std::uint32_t>(loser),
+            timestamp,
+            session
+        });
+    }
+
+    return end;
+}
+
+
+std::size_t ComparisonLogReader::count() const {
+    std::size_t total = 0;
+    std::size_t offset = 0;
+
+    // Jump from header to header
+    while (offset < size && size - offset >= headerSize &&
+            getRaw<std::uint32_t>(data + offset) == chunkMagic) {
+        const std::uint8_t* header = data + offset;
+        std::size_t next = offset + headerSize
+            + getRaw<std::uint32_t>(header + 24)
+            + getRaw<std::uint32_t>(header + 28)
+            + getRaw<std::uint32_t>(header + 32);
+
+        if (next > size)
+            break;
+
+        total += getRaw<std::uint32_t>(header + 4);
+        offset = next;
+    }
+
+    return total;
+}
+
+
+std::vector<Comparison> ComparisonLogReader::readAll() const {
+    std::vector<Comparison> comparisons;
+    comparisons.reserve(count());
+
+    forEach([&comparisons](const Comparison& comparison) {
+        comparisons.push_back(comparison);
+    });
+
+    return comparisons;
+}
+
+
+ComparisonLogReader::~ComparisonLogReader() {
+    if (data)
+        munmap(const_cast<std::uint8_t*>(data), size);
+
+    if (fd != -1)
+        close(fd);
+}
@@ -0,0 +1,237 @@
+#include "content_hash.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// POSIX libraries
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+static constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+static constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+static constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+
+static inline std::uint64_t rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+
+static inline std::uint64_t read64(const unsigned char* p) {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+
+static inline std::uint32_t read32(const unsigned char* p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+
+static inline std::uint64_t round(std::uint64_t acc, std::uint64_t input) {
+    acc += input * prime2;
+    acc = rotl(acc, 31);
+    return acc * prime1;
+}
+
+
+static inline std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t value) {
+    acc ^= round(0, value);
+    return acc * prime1 + prime4;
+}
+
+
+ContentHash::ContentHash(std::uint64_t seed) :
+        v1(seed + prime1 + prime2),
+        v2(seed + prime2),
+        v3(seed),
+        v4(seed - prime1),
+        seed(seed),
+        totalLength(0),
+        buffered(0) {}
+
+
+void ContentHash::update(const void* data, std::size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+    totalLength += length;
+
+    // Not enough for a stripe - just remember
+    if (buffered + length < 32) {
+        std::memcpy(buffer + buffered, p, length);
+        buffered += length;
+        return;
+    }
+
+    // Complete the buffered stripe
+    if (buffered) {
+        std::memcpy(buffer + buffered, p, 32 - buffered);
+        p += 32 - buffered;
+
+        v1 = round(v1, read64(buffer));
+        v2 = round(v2, read64(buffer + 8));
+        v3 = round(v3, read64(buffer + 16));
+        v4 = round(v4, read64(buffer + 24));
+        buffered = 0;
+    }
+
+    // Main loop over whole stripes
+    while (end - p >= 32) {
+        v1 = round(v1, read64(p));
+        v2 = round(v2, read64(p + 8));
+        v3 = round(v3, read64(p + 16));
+        v4 = round(v4, read64(p + 24));
+        p += 32;
+    }
+
+    // Keep the tail
+    buffered = end - p;
+    std::memcpy(buffer, p, buffered);
+}
+
+
+std::uint64_t ContentHash::digest() const {
+    std::uint64_t h;
+
+    if (totalLength >= 32) {
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+        h = seed + prime5;
+
+    h += totalLength;
+
+    // Remaining bytes
+    const unsigned char* p = buffer;
+    const unsigned char* end = buffer + buffered;
+
+    for (; end - p >= 8; p += 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * prime1 + prime4;
+    }
+
+    if (end - p >= 4) {
+        h ^= static_cast<std::uint64_t>(read32(p)) * prime1;
+        h = rotl(h, 23) * prime2 + prime3;
+        p += 4;
+    }
+
+    for (; p < end; p++) {
+        h ^= *p * prime5;
+        h = rotl(h, 11) * prime1;
+    }
+
+    // Avalanche
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+
+std::uint64_t ContentHash::of(const void* data, std::size_t length, std::uint64_t seed) {
+    ContentHash hash(seed);
+    hash.update(data, length);
+    return hash.digest();
+}
+
+
+std::uint64_t ContentHash::ofFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return 0;
+
+    // The file is read once, front to back
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Buffer is reused by every file of the thread
+    thread_local std::vector<unsigned char> chunk(1 << 20);
+    ContentHash hash;
+
+    ssize_t bytes;
+    while ((bytes = read(fd, chunk.data(), chunk.size())) > 0)
+        hash.update(chunk.data(), bytes);
+
+    close(fd);
+
+    return bytes < 0 ? 0 : hash.digest();
+}
+
+
+std::uint64_t ContentHash::ofFile(const std::string& path, std::vector<unsigned char>& contents) {
+    contents.clear();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return 0;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // The size is a hint, the file may change meanwhile
+    struct stat info;
+    if (fstat(fd, &info) == 0)
+        contents.resize(info.st_size);
+
+    std::size_t done = 0;
+    ssize_t bytes;
+    while (true) {
+        if (done == contents.size())
+            contents.resize(std::max<std::size_t>(2 * done, 1 << 16));
+
+        bytes = read(fd, contents.data() + done, contents.size() - done);
+        if (bytes <= 0)
+            break;
+
+        done += bytes;
+    }
+
+    close(fd);
+    contents.resize(done);
+
+    return bytes < 0 ? 0 : of(contents.data(), contents.size());
+}
+
+
+std::string ContentHash::toHex(std::uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+
+    for (int i = 15; i >= 0; i--, hash >>= 4)
+        hex[i] = digits[hash & 0xf];
+
+    return hex;
+}
+
+
+bool ContentHash::fromHex(const std::string& hex, std::uint64_t& hash) {
+    if (hex.size() != 16)
+        return false;
+
+    hash = 0;
+    for (char digit : hex) {
+        if (digit >= '0' && digit <= '9')
+            hash = (hash << 4) | (digit - '0');
+        else if (digit >= 'a' && digit <= 'f')
+            hash = (hash << 4) | (digit - 'a' + 10);
+        else
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,280 @@
+#include "convergence_tracker.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+
+ConvergenceTracker::ConvergenceTracker(std::size_t window, std::size_t topCount) :
+        window(std::max<std::size_t>(window, 1)),
+        topCount(std::max<std::size_t>(topCount, 1)),
+        votes(0),
+        started(false),
+        seen(0),
+        deviationSum(0.0),
+        present(0),
+        stopping(false),
+        compared(false),
+        tau(1.0),
+        topKept(0),
+        meanDeviation(0.0) {
+    thread = std::thread(&ConvergenceTracker::work, this);
+}
+
+
+void ConvergenceTracker::touch(std::size_t index) {
+    changed.push_back(index);
+}
+
+
+void ConvergenceTracker::record(const std::vector<PictureRecord>& pictures) {
+    // The first vote sets the baseline
+    if (!started || ++votes >= window) {
+        checkpoint(pictures);
+        started = true;
+        votes = 0;
+    }
+}
+
+
+void ConvergenceTracker::checkpoint(const std::vector<PictureRecord>& pictures) {
+    std::vector<Sample> samples;
+    auto sample = [&](std::size_t index) {
+        if (index < pictures.size()) {
+            const PictureRecord& picture = pictures[index];
+            samples.push_back({picture.id, picture.elo, picture.deviation, picture.removed});
+        }
+    };
+
+    // New pictures, then the touched ones
+    for (; seen < pictures.size(); seen++)
+        sample(seen);
+
+    for (auto index : changed)
+        sample(index);
+
+    for (auto index : previous)
+        sample(index);
+
+    previous = std::move(changed);
+    changed.clear();
+
+    {
+        std::lock_guard lock(mutex);
+        batches.push_back(std::move(samples));
+    }
+    condition.notify_one();
+}
+
+
+void ConvergenceTracker::work() {
+    while (true) {
+        std::vector<Sample> samples;
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !batches.empty(); });
+
+            if (stopping)
+                return;
+
+            samples = std::move(batches.front());
+            batches.pop_front();
+        }
+
+        compare(samples);
+    }
+}
+
+
+std::size_t ConvergenceTracker::countInversions(std::vector<std::pair<Entry, Entry>>& moved) {
+    // Ranks of new ratings, in the old order
+    std::vector<Entry> newOrder;
+    for (auto& [before, after] : moved)
+        newOrder.push_back(after);
+    std::sort(newOrder.begin(), newOrder.end());
+
+    std::sort(moved.begin(), moved.end());
+
+    // Fenwick tree over new ranks: how many seen so far are above
+    std::vector<std::size_t> tree(moved.size() + 1, 0);
+    std::size_t inversions = 0;
+
+    for (std::size_t i = 0; i < moved.size(); i++) {
+        std::size_t rank = std::lower_bound(newOrder.begin(), newOrder.end(), moved[i].second) - newOrder.begin() + 1;
+
+        std::size_t below = 0;
+        for (std::size_t j = rank; j > 0; j -= j & -j)
+            below += tree[j];
+        inversions += i - below;
+
+        for (std::size_t j = rank; j < tree.size(); j += j & -j)
+            tree[j]++;
+    }
+
+    return inversions;
+}
+
+
+void ConvergenceTracker::compare(std::vector<Sample>& samples) {
+    constexpr double unknown = std::numeric_limits<double>::quiet_NaN();
+
+    // A picture may be touched many times
+    std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.id < b.id; });
+    samples.erase(std::unique(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.id == b.id; }),
+                  samples.end());
+
+    // Pictures with a new rating, and new pictures
+    std::vector<std::pair<Entry, Entry>> moved;
+    std::vector<Entry> added;
+
+    for (auto& picture : samples) {
+        if (picture.id >= ratings.size()) {
+            ratings.resize(picture.id + 1, unknown);
+            deviations.resize(picture.id + 1, unknown);
+        }
+
+        // Mean deviation of present pictures
+        double& counted = deviations[picture.id];
+        if (!std::isnan(counted)) {
+            deviationSum -= counted;
+            present--;
+        }
+
+        counted = picture.removed ? unknown : picture.deviation;
+        if (!picture.removed) {
+            deviationSum += counted;
+            present++;
+        }
+
+        double before = ratings[picture.id];
+        if (std::isnan(before))
+            added.emplace_back(picture.elo, picture.id);
+        else if (before != picture.elo)
+            moved.push_back({{before, picture.id}, {picture.elo, picture.id}});
+    }
+
+    double mean = present ? deviationSum / present : 0.0;
+    double distance = -1.0;
+
+    // Kendall distance over pictures known a window ago //
+
+    if (order.size() > 1) {
+        std::vector<Entry> movedBefore;
+        for (auto& [before, after] : moved)
+            movedBefore.push_back(before);
+        std::sort(movedBefore.begin(), movedBefore.end());
+
+        // Moved and unmoved: the unmoved ones passed on the way
+        distance = 0.0;
+        for (auto& [before, after] : moved) {
+            Entry low = std::min(before, after);
+            Entry high = std::max(before, after);
+
+            auto between = [&](const std::vector<Entry>& entries) {
+                return std::lower_bound(entries.begin(), entries.end(), high) -
+                        std::upper_bound(entries.begin(), entries.end(), low);
+            };
+
+            distance += between(order) - between(movedBefore);
+        }
+
+        // Moved among themselves
+        distance += countInversions(moved);
+    }
+
+    double pairs = 0.5 * order.size() * (order.size() - 1);
+
+    // Remember the current ranking //
+
+    std::vector<char> isMoved(ratings.size(), 0);
+    for (auto& [before, after] : moved) {
+        isMoved[before.second] = 1;
+        added.push_back(after);
+    }
+
+    std::vector<Entry> kept;
+    kept.reserve(order.size());
+    std::copy_if(order.begin(), order.end(), std::back_inserter(kept),
+        [&](const Entry& entry) { return !isMoved[entry.second]; });
+
+    std::sort(added.begin(), added.end());
+    for (auto& [rating, id] : added)
+        ratings[id] = rating;
+
+    std::vector<Entry> merged;
+    merged.reserve(kept.size() + added.size());
+    std::merge(kept.begin(), kept.end(), added.begin(), added.end(), std::back_inserter(merged));
+
+    order = std::move(merged);
+
+    // Top pictures, how many stayed
+    std::vector<std::uint32_t> newTop;
+    for (auto it = order.rbegin(); it != order.rend() && newTop.size() < topCount; ++it)
+        newTop.push_back(it->second);
+
+    std::size_t stayed = std::count_if(newTop.begin(), newTop.end(), [&](std::uint32_t id) {
+        return std::find(top.begin(), top.end(), id) != top.end();
+    });
+
+    top = std::move(newTop);
+
+    std::lock_guard lock(mutex);
+    meanDeviation = mean;
+    topKept = stayed;
+    if (distance >= 0.0) {
+        tau = 1.0 - 2.0 * distance / pairs;
+        compared = true;
+    }
+}
+
+
+bool ConvergenceTracker::isReady() const {
+    std::lock_guard lock(mutex);
+    return compared;
+}
+
+
+std::size_t ConvergenceTracker::getVotesLeft() const {
+    // The first vote only sets the baseline
+    return started ? window - votes : window + 1;
+}
+
+
+std::size_t ConvergenceTracker::getWindow() const {
+    return window;
+}
+
+
+std::size_t ConvergenceTracker::getTopCount() const {
+    return topCount;
+}
+
+
+double ConvergenceTracker::getTau() const {
+    std::lock_guard lock(mutex);
+    return tau;
+}
+
+
+std::size_t ConvergenceTracker::getTopKept() const {
+    std::lock_guard lock(mutex);
+    return topKept;
+}
+
+
+double ConvergenceTracker::getMeanDeviation() const {
+    std::lock_guard lock(mutex);
+    return meanDeviation;
+}
+
+
+ConvergenceTracker::~ConvergenceTracker() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    condition.notify_one();
+    thread.join();
+}
@@ -0,0 +1,35 @@
+#include "counting_resource.hpp"
+
+
+CountingResource::CountingResource(std::pmr::memory_resource* upstream) :
+        upstream(upstream),
+        allocations(0),
+        bytes(0) {}
+
+
+void* CountingResource::do_allocate(std::size_t size, std::size_t alignment) {
+    allocations++;
+    bytes += size;
+
+    return upstream->allocate(size, alignment);
+}
+
+
+void CountingResource::do_deallocate(void* pointer, std::size_t size, std::size_t alignment) {
+    upstream->deallocate(pointer, size, alignment);
+}
+
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+
+std::size_t CountingResource::getAllocations() const {
+    return allocations;
+}
+
+
+std::size_t CountingResource::getBytes() const {
+    return bytes;
+}
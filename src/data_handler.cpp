@@ -6,11 +6,22 @@
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <algorithm>
+
+// Custom libraries
+#include "content_hash.hpp"
+#include "elo_rating.hpp"
+#include "glicko_rating.hpp"
 
 // Library for JSON jandling
 #include "json.hpp"
 
-DataHandler::DataHandler(std::string path) : path(path + "/statistics.json") {}
+DataHandler::DataHandler(std::string path, PictureNames& names) : 
+        path(path.empty() ? path : path + "/statistics.json"),
+        names(names),
+        data(nlohmann::json::object()),
+        nextId(0),
+        savedIds(0) {}
 
 
 int DataHandler::getItemInt(nlohmann::json& data, std::string&& itemName) const {
@@ -39,41 +50,120 @@ int DataHandler::getItemInt(nlohmann::json& data, std::string&& itemName) const
 }
 
 
+double DataHandler::getItemDouble(nlohmann::json& data, std::string&& itemName, double otherwise) const {
+    // Ratings of older versions are absent
+    auto jsonRecordItem = data.find(itemName);
+    if (jsonRecordItem == data.end() || !jsonRecordItem->is_number())
+        return otherwise;
+
+    return jsonRecordItem->get<double>();
+}
+
+
 void DataHandler::setItem(nlohmann::json& data, std::string&& itemName, auto value) const {
     data[itemName] = value;
 }
 
 
-void DataHandler::getData(std::vector<PictureRecord> &pictures) const {
+std::string DataHandler::getKey(const PictureRecord& picture) const {
+    if (picture.hash == 0)
+        return std::string(names.getName(picture.file));
+
+    return ContentHash::toHex(picture.hash);
+}
+
+
+void DataHandler::load() {
     std::ifstream infoFile;
-    nlohmann::json data;
 
-    // If something goes wrong, return
-    // That means all wins and total counter = 0
+    // If something goes wrong, keep counters = 0
+    // and give every picture a fresh id
     try {
         infoFile.open(path);
         data = nlohmann::json::parse(infoFile);
         infoFile.close();
     }
     catch (...) {
-        return;
+        data = nlohmann::json::object();
+    }
+    migrated.clear();
+
+    // Ids of pictures, that are absent now, must not be reused:
+    // the comparison log still refers to them
+    nextId = 0;
+    for (auto& jsonPictureRecord : data) {
+        if (jsonPictureRecord.contains("id"))
+            nextId = std::max<std::uint32_t>(nextId, getItemInt(jsonPictureRecord, "id") + 1);
     }
+    savedIds = nextId;
+}
 
 
+void DataHandler::fill(std::vector<PictureRecord>& pictures) {
     // Go through each record and fill the info
     for (auto& picture : pictures) {
         // try to find record in json
-        auto jsonPictureRecord = data.find(picture.name);
+        auto jsonPictureRecord = data.find(getKey(picture));
+
+        // Records of older versions are keyed by file name. With
+        // subfolders the name may stand for several files, only
+        // the first one takes the record, the rest are new
+        if (jsonPictureRecord == data.end()) {
+            std::string name(names.getName(picture.file));
+            jsonPictureRecord = data.find(name);
+            if (jsonPictureRecord != data.end() && !migrated.insert(name).second)
+                jsonPictureRecord = data.end();
+        }
 
         if (jsonPictureRecord != data.end()) {
             picture.wins = getItemInt(*jsonPictureRecord, "wins");
             picture.total = getItemInt(*jsonPictureRecord, "total");
+            picture.elo = getItemDouble(*jsonPictureRecord, "elo", EloRating::initial);
+            picture.glicko = getItemDouble(*jsonPictureRecord, "glicko", GlickoRating::initialRating);
+            picture.deviation = getItemDouble(*jsonPictureRecord, "deviation", GlickoRating::initialDeviation);
+            picture.volatility = getItemDouble(*jsonPictureRecord, "volatility", GlickoRating::initialVolatility);
+            picture.period = getItemInt(*jsonPictureRecord, "period");
         }
+
+        if (jsonPictureRecord != data.end() && jsonPictureRecord->contains("id"))
+            picture.id = getItemInt(*jsonPictureRecord, "id");
+        else
+            picture.id = nextId++;
     }
 }
 
 
+void DataHandler::getData(std::vector<PictureRecord>& pictures) {
+    load();
+    fill(pictures);
+}
+
+
+void DataHandler::getRecords(std::vector<PictureRecord>& pictures) {
+    for (auto& [key, jsonPictureRecord] : data.items()) {
+        if (!jsonPictureRecord.is_object() || !jsonPictureRecord.contains("id"))
+            continue;
+
+        PictureRecord picture{};
+
+        // Records of older versions are keyed by file name
+        std::string name = key;
+        if (ContentHash::fromHex(key, picture.hash) && jsonPictureRecord.contains("name"))
+            name = jsonPictureRecord["name"].get<std::string>();
+
+        picture.file = names.add("", name);
+        pictures.push_back(picture);
+    }
+
+    // The rest as for present pictures
+    fill(pictures);
+}
+
+
 void DataHandler::updateData(const std::vector<PictureRecord> &pictures) {
+    if (path.empty())
+        return;
+
     std::ifstream infoFileIn(path);
     nlohmann::json data;
 
@@ -100,18 +190,45 @@ void DataHandler::updateData(const std::vector<PictureRecord> &pictures) {
     infoFileIn.close();
 
     // Go through each record and fill the info
+    std::uint32_t written = 0;
     for (auto& picture : pictures) {
+        written = std::max(written, picture.id + 1);
+
         // Temporary object
         nlohmann::json newJsonRecord;
 
         // Set the values to the temporary
         setItem(newJsonRecord, "wins", picture.wins);
         setItem(newJsonRecord, "total", picture.total);
+        setItem(newJsonRecord, "elo", picture.elo);
+        setItem(newJsonRecord, "glicko", picture.glicko);
+        setItem(newJsonRecord, "deviation", picture.deviation);
+        setItem(newJsonRecord, "volatility", picture.volatility);
+        setItem(newJsonRecord, "period", picture.period);
+        std::string name(names.getName(picture.file));
+        setItem(newJsonRecord, "id", picture.id);
+        setItem(newJsonRecord, "name", name);
 
         // Create or replace record with a new one
-        data[picture.name] = newJsonRecord;
+        // Record under the file name is migrated to the hash
+        std::string key = getKey(picture);
+        if (key != name && data.is_object())
+            data.erase(name);
+
+        data[key] = newJsonRecord;
     }
 
     std::ofstream infoFileOut(path);
-    infoFileOut << data;
+    if (!(infoFileOut << data)) {
+        std::cout << "Could not save " << path << std::endl;
+        return;
+    }
+
+    if (written > savedIds)
+        savedIds = written;
+}
+
+
+std::uint32_t DataHandler::getSavedIds() const {
+    return savedIds;
 }
\ No newline at end of file
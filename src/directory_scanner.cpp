@@ -0,0 +1,294 @@
+#include "directory_scanner.hpp"
+
+// Custom libraries
+#include "counting_resource.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// POSIX libraries
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+
+// Initial arena of a scanning thread, enough for names of a few thousand files
+static constexpr std::size_t arenaSize = 1 << 16;
+
+// Batches are reserved up to this size at once
+static constexpr std::size_t maxBatchCapacity = 1024;
+
+
+double ScanStats::filesPerSecond() const {
+    return seconds > 0 ? files / seconds : 0;
+}
+
+
+DirectoryScanner::DirectoryScanner(PictureNames& names, ScanOptions options, ScanManifest* manifest) : 
+        options(options),
+        names(names),
+        manifest(manifest) {}
+
+
+bool DirectoryScanner::listDirectory(const std::filesystem::path& directory,
+                                        std::size_t thread, std::size_t batchSize, const Sink& sink,
+                                        std::vector<std::filesystem::path>& subdirectories,
+                                        std::pmr::memory_resource& arena) const {
+    // Batches are handed out, so they are not made in the arena
+    std::size_t batchCapacity = std::min(batchSize, maxBatchCapacity);
+    std::vector<PictureRecord> found;
+    found.reserve(batchCapacity);
+
+    // Unchanged directory is not listed at all //
+
+    std::int64_t mtime = -1;
+    if (manifest) {
+        std::vector<std::string> restoredSubdirectories;
+        mtime = ScanManifest::modificationTime(directory.native());
+
+        if (manifest->restore(directory.native(), mtime, names, found, restoredSubdirectories)) {
+            if (options.recursive) {
+                for (auto& subdirectory : restoredSubdirectories)
+                    subdirectories.push_back(subdirectory);
+            }
+
+            // Hand out in batches as if it was listed
+            for (std::size_t first = 0; first < found.size(); first += batchSize) {
+                std::size_t last = std::min(found.size(), first + std::min(batchSize, found.size()));
+                std::vector<PictureRecord> batch(found.begin() + first, found.begin() + last);
+
+                if (!sink(thread, std::move(batch)))
+                    return false;
+            }
+
+            return true;
+        }
+    }
+
+    // List the directory //
+
+    // Names for the manifest, every name ends with '\0'
+    std::pmr::string subdirectoryNames(&arena), pictureNames(&arena);
+
+    // Unreadable directories are skipped
+    std::unique_ptr<DIR, int (*)(DIR*)> listing(opendir(directory.c_str()), &closedir);
+    if (!listing)
+        return true;
+
+    bool error = false;
+    while (true) {
+        errno = 0;
+        dirent* entry = readdir(listing.get());
+        if (!entry) {
+            error = errno != 0;
+            break;
+        }
+
+        std::string_view name(entry->d_name);
+        if (name == "." || name == "..")
+            continue;
+
+        // Type comes from the listing itself, no extra stat.
+        // Links to directories are not followed to avoid cycles
+        bool isDirectory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat info;
+            isDirectory = fstatat(dirfd(listing.get()), entry->d_name, &info, AT_SYMLINK_NOFOLLOW) == 0 &&
+                            S_ISDIR(info.st_mode);
+        }
+
+        if (isDirectory) {
+            if (options.recursive)
+                subdirectories.push_back(directory / name);
+
+            subdirectoryNames.append(name).push_back('\0');
+        }
+        else if (isPicture(name)) {
+            pictureNames.append(name).push_back('\0');
+
+            found.push_back(PictureRecord{.file = names.add(directory.native(), name)});
+
+            // Hand out the full batch
+            if (found.size() >= batchSize) {
+                if (!sink(thread, std::move(found)))
+                    return false;
+
+                found.clear();
+                found.reserve(batchCapacity);
+            }
+        }
+    }
+
+    if (!found.empty() && !sink(thread, std::move(found)))
+        return false;
+
+    // Only complete listings are remembered
+    if (manifest && !error)
+        manifest->updateDirectory(directory.native(), mtime, subdirectoryNames, pictureNames);
+
+    return true;
+}
+
+
+void DirectoryScanner::run(const std::string& root, std::size_t batchSize, const Sink& sink,
+                            const DirectoryCallback& onDirectory) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::size_t threadCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    if (!options.recursive)
+        threadCount = 1;
+
+    // Shared queue of directories to list
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::filesystem::path> queue{root};
+    std::size_t busy = 0;
+    std::size_t directories = 0;
+    std::atomic<std::size_t> files = 0;
+    bool cancelled = false;
+
+    // Upstream of the arenas
+    CountingResource memory;
+
+    // Count pictures on their way out
+    Sink counted = [&](std::size_t thread, std::vector<PictureRecord>&& found) {
+        files += found.size();
+        return sink(thread, std::move(found));
+    };
+
+    auto worker = [&](std::size_t thread) {
+        std::vector<std::filesystem::path> subdirectories;
+
+        // Temporaries of a listing, the buffer is reused for every directory
+        std::pmr::vector<std::byte> buffer(arenaSize, &memory);
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), &memory);
+
+        while (true) {
+            std::filesystem::path directory;
+            {
+                // Wait for work, or for everybody to finish
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [&]() { return !queue.empty() || busy == 0 || cancelled; });
+
+                if (queue.empty() || cancelled)
+                    return;
+
+                directory = std::move(queue.front());
+                queue.pop_front();
+                busy++;
+            }
+
+            if (onDirectory)
+                onDirectory(directory.string());
+
+            subdirectories.clear();
+            bool proceed = listDirectory(directory, thread, batchSize, counted, subdirectories, arena);
+            arena.release();
+
+            {
+                std::lock_guard lock(mutex);
+                for (auto& subdirectory : subdirectories)
+                    queue.push_back(std::move(subdirectory));
+
+                busy--;
+                directories++;
+                cancelled = cancelled || !proceed;
+            }
+            condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < threadCount; i++)
+        threads.emplace_back(worker, i);
+    worker(0);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    stats = ScanStats{files, directories, threadCount, elapsed.count(), memory.getAllocations()};
+}
+
+
+std::vector<PictureRecord> DirectoryScanner::scan(const std::string& root) {
+    std::size_t threadCount = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    // Every thread keeps its own results, no lock needed
+    std::vector<std::vector<PictureRecord>> results(threadCount);
+
+    run(root, std::numeric_limits<std::size_t>::max(),
+        [&results](std::size_t thread, std::vector<PictureRecord>&& found) {
+            std::move(found.begin(), found.end(), std::back_inserter(results[thread]));
+            return true;
+        }
+    );
+
+    // Merge and order, so that the result does not depend on timing
+    std::size_t total = 0;
+    for (auto& found : results)
+        total += found.size();
+
+    std::vector<std::pair<std::string, PictureRecord>> byPath;
+    byPath.reserve(total);
+    for (auto& found : results) {
+        for (auto& picture : found)
+            byPath.emplace_back(names.getPath(picture.file), picture);
+    }
+
+    std::sort(byPath.begin(), byPath.end(),
+        [](const auto& first, const auto& second) {
+            return first.first < second.first;
+        }
+    );
+
+    std::vector<PictureRecord> pictures;
+    pictures.reserve(total);
+    for (auto& [path, picture] : byPath)
+        pictures.push_back(picture);
+
+    return pictures;
+}
+
+
+void DirectoryScanner::scan(const std::string& root, const BatchCallback& onBatch, std::size_t batchSize,
+                                const DirectoryCallback& onDirectory) {
+    run(root, batchSize,
+        [&onBatch](std::size_t, std::vector<PictureRecord>&& found) {
+            return onBatch(std::move(found));
+        },
+        onDirectory
+    );
+}
+
+
+const ScanStats& DirectoryScanner::getStats() const {
+    return stats;
+}
+
+
+bool DirectoryScanner::isPicture(std::string_view path) {
+    // As std::filesystem::path::extension(): a leading dot does not start one
+    std::string_view name = path.substr(path.rfind('/') + 1);
+    std::size_t dot = name.rfind('.');
+    if (dot == std::string_view::npos || dot == 0)
+        return false;
+
+    std::string_view extension = name.substr(dot);
+    return (
+        extension == ".jpg" ||
+        extension == ".jpeg" ||
+        extension == ".png" ||
+        extension == ".bmp"
+    );
+}
@@ -0,0 +1,169 @@
+#include "directory_watcher.hpp"
+
+// Custom libraries
+#include "directory_scanner.hpp"
+
+// C++ standard libraries
+#include <cstdint>
+#include <iostream>
+
+#ifdef __linux__
+// Linux libraries
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef __linux__
+
+DirectoryWatcher::DirectoryWatcher(bool recursive) :
+        fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+        recursive(recursive),
+        buffer(64 * 1024) {
+    if (fd == -1)
+        std::cout << "Could not watch the folder, new pictures need restart" << std::endl;
+}
+
+
+void DirectoryWatcher::watch(const std::string& directory) {
+    if (fd == -1)
+        return;
+
+    // Files are reported when written and closed,
+    // directories as soon as they appear
+    int wd = inotify_add_watch(fd, directory.c_str(),
+        IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE | IN_CREATE | IN_ONLYDIR);
+
+    if (wd == -1)
+        return;
+
+    std::lock_guard lock(mutex);
+    directories[wd] = directory;
+}
+
+
+std::vector<WatchEvent> DirectoryWatcher::poll() {
+    std::vector<WatchEvent> events;
+    if (fd == -1)
+        return events;
+
+    // First halves of renames, by cookie
+    std::unordered_map<std::uint32_t, std::pair<std::string, bool>> movedFrom;
+
+    std::lock_guard lock(mutex);
+
+    ssize_t length;
+    while ((length = read(fd, buffer.data(), buffer.size())) > 0) {
+        for (char* it = buffer.data(); it < buffer.data() + length; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(it);
+            it += sizeof(inotify_event) + event->len;
+
+            // Some events were dropped by the kernel
+            if (event->mask & IN_Q_OVERFLOW) {
+                std::cout << "Too many changes in the folder, some of them are missed" << std::endl;
+                continue;
+            }
+
+            // Watched directory itself is gone
+            if (event->mask & IN_IGNORED) {
+                directories.erase(event->wd);
+                continue;
+            }
+
+            auto directory = directories.find(event->wd);
+            if (directory == directories.end() || event->len == 0)
+                continue;
+
+            std::string path = directory->second + "/" + event->name;
+            bool isDirectory = event->mask & IN_ISDIR;
+
+            // Directories matter only in recursive mode
+            if (isDirectory && !recursive)
+                continue;
+
+            if (!isDirectory && !DirectoryScanner::isPicture(path) && !(event->mask & IN_MOVED_FROM))
+                continue;
+
+            if (event->mask & IN_MOVED_FROM) {
+                movedFrom[event->cookie] = {path, isDirectory};
+            }
+            else if (event->mask & IN_MOVED_TO) {
+                auto source = movedFrom.find(event->cookie);
+
+                if (source == movedFrom.end() || isDirectory) {
+                    // Came from outside, or a whole directory moved
+                    if (isDirectory && source != movedFrom.end())
+                        events.push_back(WatchEvent{WatchEventType::DIRECTORY_REMOVED, source->second.first, ""});
+
+                    events.push_back(WatchEvent{
+                        isDirectory ? WatchEventType::DIRECTORY_ADDED : WatchEventType::ADDED,
+                        path,
+                        ""
+                    });
+                }
+                else if (!DirectoryScanner::isPicture(source->second.first)) {
+                    // Temporary file renamed to a picture
+                    events.push_back(WatchEvent{WatchEventType::ADDED, path, ""});
+                }
+                else {
+                    events.push_back(WatchEvent{WatchEventType::RENAMED, source->second.first, path});
+                }
+
+                if (source != movedFrom.end())
+                    movedFrom.erase(source);
+            }
+            else if (event->mask & IN_DELETE) {
+                events.push_back(WatchEvent{
+                    isDirectory ? WatchEventType::DIRECTORY_REMOVED : WatchEventType::REMOVED,
+                    path,
+                    ""
+                });
+            }
+            else if (event->mask & IN_CREATE) {
+                // Files are reported on IN_CLOSE_WRITE
+                if (isDirectory)
+                    events.push_back(WatchEvent{WatchEventType::DIRECTORY_ADDED, path, ""});
+            }
+            else if (event->mask & IN_CLOSE_WRITE) {
+                events.push_back(WatchEvent{WatchEventType::ADDED, path, ""});
+            }
+        }
+    }
+
+    // Moved out of the folder
+    for (auto& [cookie, source] : movedFrom) {
+        auto& [path, isDirectory] = source;
+
+        if (isDirectory)
+            events.push_back(WatchEvent{WatchEventType::DIRECTORY_REMOVED, path, ""});
+        else if (DirectoryScanner::isPicture(path))
+            events.push_back(WatchEvent{WatchEventType::REMOVED, path, ""});
+    }
+
+    return events;
+}
+
+
+DirectoryWatcher::~DirectoryWatcher() {
+    if (fd != -1)
+        close(fd);
+}
+
+#else
+
+// No inotify - the folder is read only at start
+
+DirectoryWatcher::DirectoryWatcher(bool recursive) : fd(-1), recursive(recursive) {}
+
+void DirectoryWatcher::watch(const std::string& directory) {}
+
+std::vector<WatchEvent> DirectoryWatcher::poll() { return {}; }
+
+DirectoryWatcher::~DirectoryWatcher() {}
+
+#endif
+
+
+bool DirectoryWatcher::isOpen() const {
+    return fd != -1;
+}
@@ -0,0 +1,96 @@
+#include "duplicate_index.hpp"
+
+// Custom libraries
+#include "perceptual_hash.hpp"
+
+// C++ standard libraries
+#include <utility>
+
+
+DuplicateIndex::DuplicateIndex() : duplicates(0) {}
+
+
+void DuplicateIndex::add(std::uint32_t id, std::uint64_t hash) {
+    if (id >= parents.size()) {
+        std::size_t oldSize = parents.size();
+        hashes.resize(id + 1, 0);
+        parents.resize(id + 1);
+        sizes.resize(id + 1, 1);
+
+        for (std::size_t i = oldSize; i < parents.size(); i++)
+            parents[i] = i;
+    }
+
+    // Unknown, or added already
+    if (hash == 0 || hashes[id] == hash)
+        return;
+
+    hashes[id] = hash;
+
+    if (buckets[0].empty()) {
+        for (auto& part : buckets)
+            part.resize(1 << 16);
+    }
+
+    // Look up similar pictures //
+
+    for (int part = 0; part < parts; part++) {
+        std::uint16_t value = hash >> (16 * part);
+
+        // The value itself, then with every bit flipped
+        for (int bit = -1; bit < 16; bit++) {
+            std::uint16_t probe = bit == -1 ? value : value ^ (1 << bit);
+
+            for (std::uint32_t other : buckets[part][probe]) {
+                if (other != id && PerceptualHash::distance(hash, hashes[other]) <= maxDistance)
+                    unite(id, other);
+            }
+        }
+    }
+
+    for (int part = 0; part < parts; part++)
+        buckets[part][static_cast<std::uint16_t>(hash >> (16 * part))].push_back(id);
+}
+
+
+void DuplicateIndex::unite(std::uint32_t first, std::uint32_t second) {
+    first = find(first);
+    second = find(second);
+
+    if (first == second)
+        return;
+
+    // Smaller group joins the larger one
+    if (sizes[first] < sizes[second])
+        std::swap(first, second);
+
+    // Pictures, that were alone, become duplicates
+    duplicates += (sizes[first] == 1) + (sizes[second] == 1);
+
+    parents[second] = first;
+    sizes[first] += sizes[second];
+}
+
+
+std::uint32_t DuplicateIndex::find(std::uint32_t id) {
+    if (id >= parents.size())
+        return id;
+
+    // Path halving
+    while (parents[id] != id) {
+        parents[id] = parents[parents[id]];
+        id = parents[id];
+    }
+
+    return id;
+}
+
+
+bool DuplicateIndex::sameGroup(std::uint32_t first, std::uint32_t second) {
+    return find(first) == find(second);
+}
+
+
+std::size_t DuplicateIndex::getDuplicateCount() const {
+    return duplicates;
+}
@@ -0,0 +1,18 @@
+#include "elo_rating.hpp"
+
+// C++ standard libraries
+#include <cmath>
+
+
+double EloRating::expected(double rating, double opponent) {
+    return 1.0 / (1.0 + std::pow(10.0, (opponent - rating) / 400.0));
+}
+
+
+void EloRating::update(PictureRecord& winner, PictureRecord& loser) {
+    // The same amount moves from the loser to the winner
+    double change = factor * (1.0 - expected(winner.elo, loser.elo));
+
+    winner.elo += change;
+    loser.elo -= change;
+}
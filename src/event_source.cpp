@@ -0,0 +1,174 @@
+#include "event_source.hpp"
+
+// C++ standard libraries
+#include <iostream>
+
+
+// "RRE2", older recordings have no pairs
+static constexpr std::uint32_t recordingMagic = 0x32455252;
+
+// Kinds of entries
+static constexpr std::uint8_t eventEntry = 0;
+static constexpr std::uint8_t pairEntry = 1;
+
+
+template<typename T>
+static void writeRaw(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+template<typename T>
+static bool readRaw(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+
+// Input, that changes the session, not the mouse motion
+static bool isRecorded(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_WINDOWEVENT:
+        case SDL_QUIT:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+LiveEventSource::LiveEventSource(const std::string& recordPath, std::uint32_t seed) :
+        frame(0) {
+    if (recordPath.empty())
+        return;
+
+    file.open(recordPath, std::ios::binary);
+    if (!file) {
+        std::cout << "Could not record to " << recordPath << std::endl;
+        return;
+    }
+
+    writeRaw<std::uint32_t>(file, recordingMagic);
+    writeRaw<std::uint32_t>(file, seed);
+    writeRaw<std::uint32_t>(file, sizeof(SDL_Event));
+}
+
+
+bool LiveEventSource::poll(SDL_Event& event) {
+    if (!SDL_PollEvent(&event))
+        return false;
+
+    if (file.is_open() && isRecorded(event)) {
+        writeRaw(file, frame);
+        writeRaw(file, eventEntry);
+        writeRaw(file, event);
+    }
+
+    return true;
+}
+
+
+void LiveEventSource::endFrame() {
+    frame++;
+}
+
+
+void LiveEventSource::showPair(std::uint32_t first, std::uint32_t second) {
+    if (!file.is_open())
+        return;
+
+    writeRaw(file, frame);
+    writeRaw(file, pairEntry);
+    writeRaw(file, first);
+    writeRaw(file, second);
+}
+
+
+ReplayEventSource::ReplayEventSource(const std::string& path) :
+        next(0),
+        shown(0),
+        reported(false),
+        frame(0),
+        seed(0),
+        open(false) {
+    std::ifstream file(path, std::ios::binary);
+
+    std::uint32_t magic, eventSize;
+    if (!readRaw(file, magic) || magic != recordingMagic || !readRaw(file, seed) ||
+            !readRaw(file, eventSize) || eventSize != sizeof(SDL_Event)) {
+        std::cout << "Could not replay " << path << std::endl;
+        return;
+    }
+
+    // A cut tail is ignored
+    Entry entry;
+    std::uint8_t kind;
+    std::pair<std::uint32_t, std::uint32_t> pair;
+    while (readRaw(file, entry.frame) && readRaw(file, kind)) {
+        if (kind == eventEntry && readRaw(file, entry.event))
+            entries.push_back(entry);
+        else if (kind == pairEntry && readRaw(file, pair.first) && readRaw(file, pair.second))
+            pairs.push_back(pair);
+        else
+            break;
+    }
+
+    open = true;
+}
+
+
+bool ReplayEventSource::isOpen() const {
+    return open;
+}
+
+
+std::uint32_t ReplayEventSource::getSeed() const {
+    return seed;
+}
+
+
+std::size_t ReplayEventSource::size() const {
+    return entries.size();
+}
+
+
+bool ReplayEventSource::poll(SDL_Event& event) {
+    // Nothing left, the session is over
+    if (next == entries.size()) {
+        if (!reported && shown == pairs.size())
+            std::cout << "All " << shown << " pairs as recorded" << std::endl;
+        else if (!reported)
+            std::cout << "Shown " << shown << " of " << pairs.size() << " recorded pairs" << std::endl;
+        reported = true;
+
+        event = SDL_Event{};
+        event.type = SDL_QUIT;
+        return true;
+    }
+
+    if (entries[next].frame > frame)
+        return false;
+
+    event = entries[next++].event;
+    return true;
+}
+
+
+void ReplayEventSource::endFrame() {
+    frame++;
+}
+
+
+void ReplayEventSource::showPair(std::uint32_t first, std::uint32_t second) {
+    // Only the first difference is reported, the rest follow from it
+    if (!reported && (shown == pairs.size() || pairs[shown] != std::pair(first, second))) {
+        std::cout << "Pair " << shown + 1 << " differs from the recording" << std::endl;
+        reported = true;
+    }
+
+    shown++;
+}
@@ -0,0 +1,153 @@
+#include "glicko_rating.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+
+// Glicko-2 scale: rating = 1500 + scale * mu
+static constexpr double scale = 173.7178;
+
+// Limits change of the volatility
+static constexpr double tau = 0.5;
+
+static constexpr double tolerance = 0.000001;
+
+
+// Weight of a game against an opponent with deviation phi
+static double weight(double phi) {
+    return 1.0 / std::sqrt(1.0 + 3.0 * phi * phi / (std::numbers::pi * std::numbers::pi));
+}
+
+
+GlickoRating::GlickoRating(std::size_t periodLength) :
+        periodLength(std::max<std::size_t>(periodLength, 1)),
+        votes(0),
+        period(0) {}
+
+
+void GlickoRating::add(std::size_t index, const PictureRecord& picture, const PictureRecord& opponent, double score) {
+    double mu = (picture.glicko - initialRating) / scale;
+    double opponentMu = (opponent.glicko - initialRating) / scale;
+    double g = weight(opponent.deviation / scale);
+
+    // Expected score
+    double expected = 1.0 / (1.0 + std::exp(-g * (mu - opponentMu)));
+
+    Pending& results = pending.try_emplace(index, Pending{0.0, 0.0}).first->second;
+    results.information += g * g * expected * (1.0 - expected);
+    results.improvement += g * (score - expected);
+}
+
+
+void GlickoRating::record(std::vector<PictureRecord>& pictures, std::size_t winner, std::size_t loser) {
+    // Ratings do not change within the period,
+    // so both sides see the ratings from its start
+    add(winner, pictures[winner], pictures[loser], 1.0);
+    add(loser, pictures[loser], pictures[winner], 0.0);
+
+    if (++votes >= periodLength)
+        closePeriod(pictures);
+}
+
+
+double GlickoRating::newVolatility(double phi, double sigma, double variance, double delta) {
+    double a = std::log(sigma * sigma);
+    auto f = [&](double x) {
+        double ex = std::exp(x);
+        double d = phi * phi + variance + ex;
+        return ex * (delta * delta - d) / (2.0 * d * d) - (x - a) / (tau * tau);
+    };
+
+    // Bracket the root //
+
+    double A = a, B;
+    if (delta * delta > phi * phi + variance)
+        B = std::log(delta * delta - phi * phi - variance);
+    else {
+        int k = 1;
+        while (f(a - k * tau) < 0)
+            k++;
+        B = a - k * tau;
+    }
+
+    // Narrow it down //
+
+    double fA = f(A), fB = f(B);
+    while (std::abs(B - A) > tolerance) {
+        double C = A + (A - B) * fA / (fB - fA);
+        double fC = f(C);
+
+        if (fC * fB <= 0) {
+            A = B;
+            fA = fB;
+        }
+        else
+            fA /= 2;
+
+        B = C;
+        fB = fC;
+    }
+
+    return std::exp(A / 2);
+}
+
+
+void GlickoRating::closePeriod(std::vector<PictureRecord>& pictures) {
+    // Otherwise deviations would grow without any vote
+    if (pending.empty())
+        return;
+
+    period++;
+    votes = 0;
+
+    for (auto& [index, results] : pending) {
+        PictureRecord& picture = pictures[index];
+
+        double mu = (picture.glicko - initialRating) / scale;
+        double phi = picture.deviation / scale;
+        double sigma = picture.volatility;
+
+        // Periods without comparisons add uncertainty.
+        // Counted lazily, only when the picture is compared again
+        if (picture.period != 0 && period - picture.period > 1)
+            phi = std::sqrt(phi * phi + (period - picture.period - 1) * sigma * sigma);
+        picture.period = period;
+
+        double variance = 1.0 / results.information;
+        double delta = variance * results.improvement;
+
+        sigma = newVolatility(phi, sigma, variance, delta);
+
+        double phiStar = std::sqrt(phi * phi + sigma * sigma);
+        double newPhi = 1.0 / std::sqrt(1.0 / (phiStar * phiStar) + 1.0 / variance);
+        double newMu = mu + newPhi * newPhi * results.improvement;
+
+        picture.glicko = initialRating + scale * newMu;
+        picture.deviation = std::min(initialDeviation, scale * newPhi);
+        picture.volatility = sigma;
+    }
+
+    pending.clear();
+}
+
+
+void GlickoRating::restore(const PictureRecord& picture) {
+    period = std::max(period, picture.period);
+}
+
+
+double GlickoRating::conservative(const PictureRecord& picture) {
+    return picture.glicko - 2.0 * picture.deviation;
+}
+
+
+double GlickoRating::expected(const PictureRecord& first, const PictureRecord& second) {
+    double mu = (first.glicko - second.glicko) / scale;
+
+    // Uncertainty of both ratings flattens the chances
+    double phi = std::hypot(first.deviation, second.deviation) / scale;
+
+    return 1.0 / (1.0 + std::exp(-weight(phi) * mu));
+}
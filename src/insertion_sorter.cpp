@@ -0,0 +1,188 @@
+#include "insertion_sorter.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+// Library for JSON handling
+#include "json.hpp"
+
+
+InsertionSorter::InsertionSorter(std::string path) :
+        path(path.empty() ? path : path + "/sort.json"),
+        low(0),
+        high(0),
+        modified(false) {
+    load();
+}
+
+
+void InsertionSorter::load() {
+    nlohmann::json data;
+
+    // No sort yet, or a damaged one - start over
+    try {
+        std::ifstream file(path);
+        data = nlohmann::json::parse(file);
+
+        sorted = data.at("sorted").get<std::vector<std::uint32_t>>();
+        auto waiting = data.at("pending").get<std::vector<std::uint32_t>>();
+        pending.assign(waiting.begin(), waiting.end());
+        low = data.at("low").get<std::size_t>();
+        high = data.at("high").get<std::size_t>();
+    }
+    catch (...) {
+        sorted.clear();
+        pending.clear();
+        low = high = 0;
+    }
+
+    known.insert(sorted.begin(), sorted.end());
+    known.insert(pending.begin(), pending.end());
+
+    if (low > high || high > sorted.size())
+        restart();
+
+    settle();
+    modified = false;
+}
+
+
+void InsertionSorter::restart() {
+    low = 0;
+    high = sorted.size();
+}
+
+
+void InsertionSorter::settle() {
+    while (!pending.empty() && low == high) {
+        sorted.insert(sorted.begin() + low, pending.back());
+        pending.pop_back();
+        restart();
+    }
+}
+
+
+void InsertionSorter::add(std::uint32_t id) {
+    if (!known.insert(id).second)
+        return;
+
+    // Goes behind the current candidate
+    pending.push_front(id);
+    if (pending.size() == 1)
+        restart();
+
+    settle();
+    modified = true;
+}
+
+
+void InsertionSorter::remove(std::uint32_t id) {
+    if (known.erase(id) == 0)
+        return;
+
+    auto waiting = std::find(pending.begin(), pending.end(), id);
+    if (waiting != pending.end()) {
+        // The candidate itself, the next one starts
+        if (waiting == std::prev(pending.end()))
+            restart();
+
+        pending.erase(waiting);
+    }
+    else {
+        // The range of the candidate may shift, it is searched again
+        sorted.erase(std::find(sorted.begin(), sorted.end(), id));
+        restart();
+    }
+
+    settle();
+    modified = true;
+}
+
+
+void InsertionSorter::retain(const std::vector<PictureRecord>& pictures) {
+    std::unordered_set<std::uint32_t> present;
+    for (auto& picture : pictures) {
+        if (!picture.removed)
+            present.insert(picture.id);
+    }
+
+    std::vector<std::uint32_t> absent;
+    for (auto id : known) {
+        if (!present.contains(id))
+            absent.push_back(id);
+    }
+
+    for (auto id : absent)
+        remove(id);
+}
+
+
+bool InsertionSorter::next(std::uint32_t& candidate, std::uint32_t& pivot) const {
+    if (pending.empty())
+        return false;
+
+    candidate = pending.back();
+    pivot = sorted[(low + high) / 2];
+    return true;
+}
+
+
+void InsertionSorter::answer(bool candidateWins) {
+    if (pending.empty())
+        return;
+
+    std::size_t middle = (low + high) / 2;
+    if (candidateWins)
+        high = middle;
+    else
+        low = middle + 1;
+
+    settle();
+    modified = true;
+}
+
+
+void InsertionSorter::tie() {
+    if (pending.empty())
+        return;
+
+    // Near duplicates rank together, no more questions are needed
+    low = high = (low + high) / 2;
+
+    settle();
+    modified = true;
+}
+
+
+bool InsertionSorter::isDone() const {
+    return pending.empty();
+}
+
+
+const std::vector<std::uint32_t>& InsertionSorter::getOrder() const {
+    return sorted;
+}
+
+
+void InsertionSorter::save() {
+    if (!modified || path.empty())
+        return;
+
+    nlohmann::json data;
+    data["sorted"] = sorted;
+    data["pending"] = std::vector<std::uint32_t>(pending.begin(), pending.end());
+    data["low"] = low;
+    data["high"] = high;
+
+    std::ofstream file(path);
+    file << data;
+
+    if (!file) {
+        std::cout << "Could not save " << path << std::endl;
+        return;
+    }
+
+    modified = false;
+}
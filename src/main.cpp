@@ -1,17 +1,118 @@
 // C++ standard libraries
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
 
 // Custom libraries
 #include "application.hpp"
+#include "directory_scanner.hpp"
+#include "event_source.hpp"
+#include "selection_mode.hpp"
+#include "session_options.hpp"
 
 
-int main() {
+static const char* usage =
+    "Usage: rank [-r] [-j threads] [-m mode] [-k count] [-s seed] [--record file | --replay file] [folder]";
+
+
+// Whole argument as a number not above the limit
+template<typename T>
+static bool parseNumber(const char* text, T& value, T limit = std::numeric_limits<T>::max()) {
+    T parsed;
+    const char* end = text + std::strlen(text);
+    auto [last, error] = std::from_chars(text, end, parsed);
+    if (error != std::errc() || last != end || last == text || parsed > limit)
+        return false;
+
+    value = parsed;
+    return true;
+}
+
+
+int main(int argc, char* argv[]) {
+    std::string pathToPictures = "test";
+    ScanOptions scanOptions;
+    SelectionMode selectionMode = SelectionMode::RANDOM;
+    std::size_t topCount = 10;
+    SessionOptions sessionOptions;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool valid = true;
+
+        if (argument == "-r")
+            scanOptions.recursive = true;
+        else if (argument == "-j" && i + 1 < argc)
+            valid = parseNumber(argv[++i], scanOptions.threads);
+        else if (argument == "-m" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "random")
+                selectionMode = SelectionMode::RANDOM;
+            else if (mode == "sort")
+                selectionMode = SelectionMode::SORT;
+            else if (mode == "top")
+                selectionMode = SelectionMode::TOP;
+            else
+                valid = false;
+        }
+        else if (argument == "-k" && i + 1 < argc)
+            valid = parseNumber(argv[++i], topCount) && topCount > 0;
+        else if (argument == "-s" && i + 1 < argc) {
+            std::uint32_t seed = 0;
+            valid = parseNumber(argv[++i], seed);
+            sessionOptions.seed = seed;
+        }
+        else if (argument == "--record" && i + 1 < argc)
+            sessionOptions.recordPath = argv[++i];
+        else if (argument == "--replay" && i + 1 < argc)
+            sessionOptions.replayPath = argv[++i];
+        else if (argument.starts_with("-"))
+            valid = false;
+        else
+            pathToPictures = argument;
+
+        if (!valid) {
+            std::cout << "Invalid argument " << argv[i] << std::endl << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Pictures must come in the same order every time
+    if (!sessionOptions.recordPath.empty() || !sessionOptions.replayPath.empty())
+        scanOptions.threads = 1;
+
+    // The folder must be left as the recording found it
+    if (!sessionOptions.recordPath.empty())
+        std::cout << "Votes of a recorded session are not saved" << std::endl;
+
+    if (!sessionOptions.replayPath.empty()) {
+        // A recording, that cannot be read, would replay nothing
+        sessionOptions.replay = std::make_unique<ReplayEventSource>(sessionOptions.replayPath);
+        if (!sessionOptions.replay->isOpen())
+            return EXIT_FAILURE;
+
+        std::cout << "Replaying " << sessionOptions.replay->size() << " events" << std::endl;
+
+        // Replay needs no display, unless one is asked for
+        setenv("SDL_VIDEODRIVER", "dummy", 0);
+    }
+
     Application app(
         1280,
         720,
-        "test",
+        pathToPictures,
         "fonts/MONOFONT.TTF",
-        "./background.png"
+        "./background.png",
+        scanOptions,
+        selectionMode,
+        topCount,
+        std::move(sessionOptions)
     );
 
     return app.run();
@@ -5,31 +5,55 @@
 #include "menu_events.hpp"
 #include "picture_record.hpp"
 #include "transition_state.hpp"
+#include "elo_rating.hpp"
+#include "picture_decoder.hpp"
 
 // C++ standard libraries
-#include <random>
+#include <algorithm>
 #include <string>
 #include <iostream>
 
-// SDL libraries
-#include <SDL2/SDL_image.h>
 
-
-MainMenu::MainMenu(Screen& screen, std::vector<PictureRecord>& pictures, std::string& pathToFont) :
+MainMenu::MainMenu(Screen& screen, std::vector<PictureRecord>& pictures, const PictureNames& pictureNames,
+                    const std::unordered_map<std::uint32_t, std::size_t>& idIndex, ComparisonLog& comparisonLog, DuplicateIndex& duplicateIndex,
+                    GlickoRating& glickoRating, PairHistory& pairHistory,
+                    PreferenceGraph& preferenceGraph, ConvergenceTracker& convergenceTracker,
+                    RankingIndex& rankingIndex, PairSelector& pairSelector,
+                    std::function<void(std::size_t)> removePicture,
+                    std::function<void(std::size_t, std::size_t)> showPair, SelectionMode selectionMode,
+                    std::string& pathToFont, bool waitForFiles) :
         font(nullptr),
         leftTexture(nullptr),
         rightTexture(nullptr),
         labelTexture(nullptr),
+        loadingTexture(nullptr),
         leftCounterTexture(nullptr),
         rightCounterTexture(nullptr),
         counterWinnerTexture(nullptr),
         pictures(pictures),
+        pictureNames(pictureNames),
+        idIndex(idIndex),
+        comparisonLog(comparisonLog),
+        duplicateIndex(duplicateIndex),
+        glickoRating(glickoRating),
+        pairHistory(pairHistory),
+        preferenceGraph(preferenceGraph),
+        convergenceTracker(convergenceTracker),
+        rankingIndex(rankingIndex),
+        selectionMode(selectionMode),
+        pairSelector(pairSelector),
+        removePicture(std::move(removePicture)),
+        showPair(std::move(showPair)),
+        waitForFiles(waitForFiles),
         fontSize(20),
         boxW(500),
         boxH(500),
         lineMargin(60),
         leftWinner(-1),
-        gen(std::random_device()()){
+        nextChosen(false),
+        readRetried(false),
+        labelShown(false) {
+
     // Setup font //
     // Open font
     font = TTF_OpenFont(pathToFont.c_str(), 50);
@@ -52,23 +76,27 @@ MainMenu::MainMenu(Screen& screen, std::vector<PictureRecord>& pictures, std::st
     labelTexture = screen.toTexture(temp);
     SDL_FreeSurface(temp);
 
-    // Get new 2 pictures
-    getRandomDouble(screen);
+    loadingText = "Loading pictures...";
+    temp = TTF_RenderText_Blended(
+        font,
+        loadingText.c_str(),
+        {128, 128, 128, 255}
+    );
+    loadingTexture = screen.toTexture(temp);
+    SDL_FreeSurface(temp);
 
-    // Reset the transition state, that getRandomDouble()
-    // establishes, to let the menu know, that it
-    // is the first transition
-    transitionState = TransitionState::FADE_IN_FIRST;
+    // Pictures may still be on their way
+    transitionState = TransitionState::WAIT;
 }
 
 
-MenuEvent MainMenu::handleEvents(Screen& screen) {
+MenuEvent MainMenu::handleEvents(Screen& screen, EventSource& events) {
     // If the end, return the toReturn immediately
     if (transitionState == TransitionState::END)
         return toReturn;
 
     // Invoke handleEvents from predecessor
-    return BaseMenu::handleEvents(screen);
+    return BaseMenu::handleEvents(screen, events);
 }
 
 
@@ -121,15 +149,61 @@ bool MainMenu::toUpdate() {
 }
 
 
-void MainMenu::getRandomDouble(Screen& screen) {
-    // Randomly choose 2 picture indexes //
+bool MainMenu::choosePair(int& left, int& right) {
+    // Removed pictures and near duplicates are skipped
+    auto accept = [this](std::size_t first, std::size_t second) {
+        return !pictures[first].removed && !pictures[second].removed &&
+                !duplicateIndex.sameGroup(pictures[first].id, pictures[second].id);
+    };
 
-    dist = std::uniform_int_distribution<>(0, pictures.size() - 1);
-    currentLeft = dist(gen);
+    // So are pairs compared before, or implied by other votes
+    auto acceptNew = [this, &accept](std::size_t first, std::size_t second) {
+        return accept(first, second) &&
+                !pairHistory.contains(pictures[first].id, pictures[second].id) &&
+                !preferenceGraph.implies(pictures[first].id, pictures[second].id);
+    };
+
+    // Once almost every pair was compared, they are repeated.
+    // The sort and the tournament ask their own questions, repeated or not
+    bool scheduled = selectionMode == SelectionMode::SORT || selectionMode == SelectionMode::TOP;
+
+    // Votes of an inconsistent cycle go first
+    std::uint32_t winner, loser;
+    while (!scheduled && preferenceGraph.takeContradiction(winner, loser)) {
+        auto first = idIndex.find(loser);
+        auto second = idIndex.find(winner);
+
+        if (first != idIndex.end() && second != idIndex.end() && accept(first->second, second->second)) {
+            left = first->second;
+            right = second->second;
+            return true;
+        }
+    }
 
-    dist = std::uniform_int_distribution<>(1, pictures.size() - 1);
-    currentRight = (currentLeft + dist(gen)) % pictures.size();
+    std::size_t first, second;
+    bool chosen = !scheduled && pairSelector.choose(pictures, acceptNew, first, second);
+    if (!chosen && !pairSelector.choose(pictures, accept, first, second))
+        return false;
+
+    left = first;
+    right = second;
+    return true;
+}
 
+
+bool MainMenu::prefetchPair() {
+    nextChosen = choosePair(nextLeft, nextRight);
+
+    if (nextChosen) {
+        prefetcher.request(pictureNames.getPath(pictures[nextLeft].file));
+        prefetcher.request(pictureNames.getPath(pictures[nextRight].file));
+    }
+
+    return nextChosen;
+}
+
+
+void MainMenu::getRandomDouble(Screen& screen) {
     // Free memory if needed //
 
     freeTexture(&leftTexture);
@@ -137,17 +211,82 @@ void MainMenu::getRandomDouble(Screen& screen) {
 
     // Get textures for pictures //
 
-    SDL_Surface* temp = IMG_Load(pictures[currentLeft].path.c_str());
-    leftTexture = screen.toTexture(temp);
-    SDL_FreeSurface(temp);
+    // Bounded, in case textures cannot be created at all
+    for (int attempt = 0; attempt < 8 && (nextChosen || prefetchPair()); attempt++) {
+        // Removed, while its files were read
+        if (pictures[nextLeft].removed || pictures[nextRight].removed) {
+            nextChosen = false;
+            continue;
+        }
 
-    temp = IMG_Load(pictures[currentRight].path.c_str());
-    rightTexture = screen.toTexture(temp);
-    SDL_FreeSurface(temp);
+        std::string leftPath = pictureNames.getPath(pictures[nextLeft].file);
+        std::string rightPath = pictureNames.getPath(pictures[nextRight].file);
+
+        // Forgotten by the prefetcher to make room, read again
+        for (std::string_view path : {leftPath, rightPath}) {
+            if (prefetcher.getStatus(path) == PrefetchStatus::NONE)
+                prefetcher.request(path);
+        }
+
+        if (waitForFiles) {
+            prefetcher.wait(leftPath);
+            prefetcher.wait(rightPath);
+        }
 
+        PrefetchStatus leftStatus = prefetcher.getStatus(leftPath);
+        PrefetchStatus rightStatus = prefetcher.getStatus(rightPath);
 
-    // Start the transition to run the application
-    startTransitionIn();
+        // A failed read is tried once more, before the picture is dropped
+        if (!readRetried && (leftStatus == PrefetchStatus::FAILED || rightStatus == PrefetchStatus::FAILED)) {
+            prefetcher.request(leftPath);
+            prefetcher.request(rightPath);
+            readRetried = true;
+
+            transitionState = TransitionState::WAIT;
+            return;
+        }
+
+        // Files are still being read - check on the next frame
+        if (leftStatus == PrefetchStatus::PENDING || rightStatus == PrefetchStatus::PENDING) {
+            transitionState = TransitionState::WAIT;
+            return;
+        }
+
+        currentLeft = nextLeft;
+        currentRight = nextRight;
+        nextChosen = false;
+        readRetried = false;
+
+        SDL_Surface* leftSurface = prefetcher.take(leftPath, leftBytes) ? PictureDecoder::decode(leftBytes) : nullptr;
+        SDL_Surface* rightSurface = prefetcher.take(rightPath, rightBytes) ? PictureDecoder::decode(rightBytes) : nullptr;
+
+        // The file vanished before the watcher noticed
+        if (!leftSurface)
+            removePicture(currentLeft);
+        if (!rightSurface)
+            removePicture(currentRight);
+
+        if (leftSurface && rightSurface) {
+            leftTexture = screen.toTexture(leftSurface);
+            rightTexture = screen.toTexture(rightSurface);
+        }
+
+        SDL_FreeSurface(leftSurface);
+        SDL_FreeSurface(rightSurface);
+
+        // Start the transition to run the application
+        if (leftTexture && rightTexture) {
+            showPair(currentLeft, currentRight);
+            startTransitionIn();
+            return;
+        }
+
+        freeTexture(&leftTexture);
+        freeTexture(&rightTexture);
+    }
+
+    // Not enough pictures - wait for more
+    transitionState = TransitionState::WAIT;
 }
 
 
@@ -513,6 +652,30 @@ void MainMenu::update(Screen& screen) {
     lineY2 = windowHeight - 10;
     // 10 and -10 are margins from edges
 
+    // Loading label in the middle of the window
+    loadingRect.w = fontSize * loadingText.size();
+    loadingRect.h = 2.4 * fontSize;
+    loadingRect.x = windowWidth / 2 - loadingRect.w / 2;
+    loadingRect.y = windowHeight / 2 - loadingRect.h / 2;
+
+    // Wait for pictures and their files //
+
+    if (transitionState == TransitionState::WAIT) {
+        // Get new 2 pictures
+        getRandomDouble(screen);
+
+        if (transitionState == TransitionState::WAIT)
+            return;
+
+        // Reset the transition state, that getRandomDouble()
+        // establishes, to let the menu know, that it
+        // is the first transition
+        if (!labelShown) {
+            transitionState = TransitionState::FADE_IN_FIRST;
+            labelShown = true;
+        }
+    }
+
     // Draw left picture //
 
     // Get size of the picture
@@ -605,6 +768,14 @@ void MainMenu::render(Screen& screen) {
         labelTexture
     );
 
+    // Textures of the pictures are freed, and their rects
+    // are not set before the first pair
+    if (transitionState == TransitionState::WAIT) {
+        screen.putTexturedRect(loadingRect.x, loadingRect.y, loadingRect.w, loadingRect.h, loadingTexture);
+        screen.show();
+        return;
+    }
+
     // render counters, if needed
     renderCounters(screen);
     // remove counters, if needed
@@ -644,20 +815,37 @@ void MainMenu::render(Screen& screen) {
 }
 
 
-void MainMenu::leftWins() {
-    pictures[currentLeft].wins++;
-    pictures[currentLeft].total++;
-    pictures[currentRight].total++;
+void MainMenu::recordVote(std::size_t winner, std::size_t loser) {
+    pictures[winner].wins++;
+    pictures[winner].total++;
+    pictures[loser].total++;
+    EloRating::update(pictures[winner], pictures[loser]);
+    glickoRating.record(pictures, winner, loser);
+    pairSelector.record(pictures, winner, loser);
+
+    comparisonLog.record(pictures[winner].id, pictures[loser].id);
+    pairHistory.insert(pictures[winner].id, pictures[loser].id);
+    preferenceGraph.record(pictures[winner].id, pictures[loser].id);
+    convergenceTracker.touch(winner);
+    convergenceTracker.touch(loser);
+    convergenceTracker.record(pictures);
+    rankingIndex.touch(winner);
+    rankingIndex.touch(loser);
+
+    // The next pair is chosen knowing the result,
+    // its files are read during the transition
+    prefetchPair();
+}
 
+
+void MainMenu::leftWins() {
+    recordVote(currentLeft, currentRight);
     leftWinner = 1;
 }
 
 
 void MainMenu::rightWins() {
-    pictures[currentRight].wins++;
-    pictures[currentRight].total++;
-    pictures[currentLeft].total++;
-
+    recordVote(currentRight, currentLeft);
     leftWinner = 0;
 }
 
@@ -666,6 +854,7 @@ MainMenu::~MainMenu() {
     freeTexture(&leftTexture);
     freeTexture(&rightTexture);
     freeTexture(&labelTexture);
+    freeTexture(&loadingTexture);
     freeTexture(&leftCounterTexture);
     freeTexture(&rightCounterTexture);
     freeTexture(&counterWinnerTexture);
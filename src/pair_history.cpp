@@ -0,0 +1,80 @@
+#include "pair_history.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <utility>
+
+
+// Odd constants picking the bit in every word
+static constexpr std::uint32_t salts[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+
+PairHistory::PairHistory(std::size_t capacity) :
+        capacity(std::clamp(capacity, minCapacity, maxCapacity)),
+        count(0),
+        // 512 bits per block, 10 bits per pair
+        current((this->capacity * 10 + 511) / 512) {}
+
+
+std::uint64_t PairHistory::key(std::uint32_t first, std::uint32_t second) {
+    if (first > second)
+        std::swap(first, second);
+
+    // splitmix64 finalizer
+    std::uint64_t hash = (static_cast<std::uint64_t>(first) << 32) | second;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+}
+
+
+bool PairHistory::test(const std::vector<Block>& blocks, std::uint64_t hash) const {
+    if (blocks.empty())
+        return false;
+
+    // High half picks the block, low half the bits
+    const Block& block = blocks[((hash >> 32) * blocks.size()) >> 32];
+    std::uint32_t low = hash;
+
+    bool found = true;
+    for (int i = 0; i < 8; i++)
+        found &= (block.words[i] >> ((low * salts[i]) >> 26)) & 1;
+
+    return found;
+}
+
+
+void PairHistory::insert(std::uint32_t first, std::uint32_t second) {
+    std::uint64_t hash = key(first, second);
+    if (test(current, hash))
+        return;
+
+    // Full, start a new generation
+    if (count >= capacity) {
+        previous = std::move(current);
+        current.assign(previous.size(), Block{});
+        count = 0;
+    }
+
+    Block& block = current[((hash >> 32) * current.size()) >> 32];
+    std::uint32_t low = hash;
+
+    for (int i = 0; i < 8; i++)
+        block.words[i] |= std::uint64_t(1) << ((low * salts[i]) >> 26);
+
+    count++;
+}
+
+
+bool PairHistory::contains(std::uint32_t first, std::uint32_t second) const {
+    std::uint64_t hash = key(first, second);
+    return test(current, hash) || test(previous, hash);
+}
+
+
+std::size_t PairHistory::getCapacity() const {
+    return capacity;
+}
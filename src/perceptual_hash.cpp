@@ -0,0 +1,83 @@
+#include "perceptual_hash.hpp"
+
+// C++ standard libraries
+#include <bit>
+
+#ifdef __SSE2__
+// SIMD intrinsics
+#include <emmintrin.h>
+#endif
+
+
+static constexpr int cellsX = 9;
+static constexpr int cellsY = 8;
+
+
+// Sum of red, green and blue over count pixels
+static std::uint64_t sumSpan(const unsigned char* pixels, int count) {
+    std::uint64_t sum = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    // 4 pixels at a time: alpha is masked out,
+    // then the bytes are summed by psadbw
+    const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i total = _mm_setzero_si128();
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i * 4));
+        total = _mm_add_epi64(total, _mm_sad_epu8(_mm_and_si128(chunk, mask), zero));
+    }
+
+    sum = _mm_cvtsi128_si64(total) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total));
+#endif
+
+    for (; i < count; i++)
+        sum += pixels[i * 4] + pixels[i * 4 + 1] + pixels[i * 4 + 2];
+
+    return sum;
+}
+
+
+std::uint64_t PerceptualHash::ofPixels(const unsigned char* pixels, int width, int height, int pitch) {
+    if (width < cellsX || height < cellsY)
+        return 0;
+
+    // Borders of the cells
+    int left[cellsX + 1];
+    for (int x = 0; x <= cellsX; x++)
+        left[x] = static_cast<long long>(x) * width / cellsX;
+
+    // One pass over the rows, every row adds to its cells
+    std::uint64_t sums[cellsY][cellsX] = {};
+    for (int y = 0; y < height; y++) {
+        int cellY = static_cast<long long>(y) * cellsY / height;
+        const unsigned char* row = pixels + static_cast<long long>(y) * pitch;
+
+        for (int x = 0; x < cellsX; x++)
+            sums[cellY][x] += sumSpan(row + left[x] * 4, left[x + 1] - left[x]);
+    }
+
+    // Compare averages of neighbours //
+
+    std::uint64_t hash = 0;
+    for (int y = 0; y < cellsY; y++) {
+        for (int x = 0; x + 1 < cellsX; x++) {
+            // Cells of a row have the same height,
+            // averages are compared by cross multiplying widths
+            std::uint64_t current = sums[y][x] * (left[x + 2] - left[x + 1]);
+            std::uint64_t next = sums[y][x + 1] * (left[x + 1] - left[x]);
+
+            if (current < next)
+                hash |= 1ULL << (y * (cellsX - 1) + x);
+        }
+    }
+
+    return hash;
+}
+
+
+int PerceptualHash::distance(std::uint64_t first, std::uint64_t second) {
+    return std::popcount(first ^ second);
+}
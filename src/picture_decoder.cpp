@@ -0,0 +1,51 @@
+#include "picture_decoder.hpp"
+
+// Custom libraries
+#include "perceptual_hash.hpp"
+
+// SDL libraries
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+
+void PictureDecoder::initialize() {
+    // SDL_image loads a format library lazily, on the first picture of the
+    // format, which is not safe from several threads. Loaded up front,
+    // decoding keeps no global state. Formats, that are missing, are not
+    // decoded at all
+    IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF | IMG_INIT_WEBP);
+}
+
+
+SDL_Surface* PictureDecoder::decode(const std::vector<unsigned char>& bytes) {
+    if (bytes.empty())
+        return nullptr;
+
+    // The stream is closed by SDL_image
+    return IMG_Load_RW(SDL_RWFromConstMem(bytes.data(), bytes.size()), 1);
+}
+
+
+std::uint64_t PictureDecoder::perceptualHash(const std::vector<unsigned char>& bytes) {
+    SDL_Surface* loaded = decode(bytes);
+    if (!loaded)
+        return 0;
+
+    // Same byte order for every format: R, G, B, A
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+
+    if (!converted)
+        return 0;
+
+    std::uint64_t hash = PerceptualHash::ofPixels(
+        static_cast<const unsigned char*>(converted->pixels),
+        converted->w,
+        converted->h,
+        converted->pitch
+    );
+
+    SDL_FreeSurface(converted);
+
+    return hash;
+}
@@ -0,0 +1,111 @@
+#include "picture_hasher.hpp"
+
+// Custom libraries
+#include "content_hash.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+
+PictureHasher::PictureHasher(const PictureNames& names, ScanManifest& manifest, PerceptualHasher perceptualHasher) :
+        names(names),
+        manifest(manifest),
+        perceptualHasher(perceptualHasher) {}
+
+
+void PictureHasher::hash(std::vector<PictureRecord>& pictures) {
+    // Files, that have to be read, as positions in toCheck
+    std::vector<std::size_t> toHash;
+    std::vector<ScanManifest::FileEntry> entries(pictures.size(), ScanManifest::FileEntry{});
+
+    // Records, that came with a hash, need no check
+    std::vector<std::size_t> toCheck;
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < pictures.size(); i++) {
+        if (pictures[i].hash == 0) {
+            toCheck.push_back(i);
+            paths.emplace_back(names.getPath(pictures[i].file));
+        }
+    }
+
+    // One submission for the whole batch
+    std::vector<BatchedIo::FileStatus> statuses;
+    io.stat(paths, statuses);
+
+    // Unchanged files are taken from cache
+    for (std::size_t j = 0; j < toCheck.size(); j++) {
+        std::size_t i = toCheck[j];
+        if (!statuses[j].exists)
+            continue;
+
+        entries[i].size = statuses[j].size;
+        entries[i].mtime = statuses[j].mtime;
+
+        ScanManifest::FileEntry cached;
+        if (manifest.findFile(paths[j], cached) &&
+                cached.size == entries[i].size &&
+                cached.mtime == entries[i].mtime) {
+            pictures[i].hash = cached.hash;
+            pictures[i].perceptual = cached.perceptual;
+        }
+        else
+            toHash.push_back(j);
+    }
+
+    if (toHash.empty())
+        return;
+
+    // Hash the rest on every core //
+
+    std::size_t threadCount = std::min<std::size_t>(
+        std::max(1u, std::thread::hardware_concurrency()),
+        toHash.size()
+    );
+
+    // Workers take next file from the shared counter
+    std::atomic<std::size_t> next = 0;
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < toHash.size(); i = next++) {
+            const std::string& path = paths[toHash[i]];
+            PictureRecord& picture = pictures[toCheck[toHash[i]]];
+
+            if (!perceptualHasher) {
+                picture.hash = ContentHash::ofFile(path);
+                continue;
+            }
+
+            // The file is read once for both hashes. Decoding is
+            // the slowest part, but it is done once per file
+            thread_local std::vector<unsigned char> contents;
+            picture.hash = ContentHash::ofFile(path, contents);
+            if (picture.hash != 0)
+                picture.perceptual = perceptualHasher(contents);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < threadCount; i++)
+        threads.emplace_back(worker);
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    // Remember new hashes
+    for (std::size_t j : toHash) {
+        std::size_t i = toCheck[j];
+        if (pictures[i].hash == 0)
+            continue;
+
+        entries[i].hash = pictures[i].hash;
+        entries[i].perceptual = pictures[i].perceptual;
+        manifest.updateFile(paths[j], entries[i]);
+    }
+}
+
+
+void PictureHasher::save() {
+    manifest.save();
+}
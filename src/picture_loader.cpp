@@ -0,0 +1,180 @@
+#include "picture_loader.hpp"
+
+// C++ standard libraries
+#include <iostream>
+#include <iterator>
+
+
+PictureLoader::PictureLoader(std::string pathToPictures, ScanOptions scanOptions, PictureNames& names,
+                                DataHandler& dataHandler, PictureHasher& pictureHasher,
+                                ScanManifest& manifest, DirectoryWatcher* watcher) :
+        pathToPictures(pathToPictures),
+        scanOptions(scanOptions),
+        names(names),
+        dataHandler(dataHandler),
+        pictureHasher(pictureHasher),
+        manifest(manifest),
+        watcher(watcher),
+        stopping(false),
+        finished(false),
+        scanFinished(false) {}
+
+
+void PictureLoader::start() {
+    scanThread = std::thread(&PictureLoader::scan, this);
+    processThread = std::thread(&PictureLoader::process, this);
+}
+
+
+void PictureLoader::scanDirectory(DirectoryScanner& scanner, const std::string& directory) {
+    // Watch before listing, so that nothing is missed in between
+    DirectoryScanner::DirectoryCallback onDirectory = nullptr;
+    if (watcher)
+        onDirectory = [this](const std::string& directory) { watcher->watch(directory); };
+
+    // Pass every batch to the processing thread
+    scanner.scan(directory, [this](std::vector<PictureRecord>&& found) {
+        {
+            std::lock_guard lock(mutex);
+            discovered.push_back(std::move(found));
+        }
+        condition.notify_all();
+
+        return !stopping;
+    }, 64, onDirectory);
+}
+
+
+void PictureLoader::scan() {
+    DirectoryScanner scanner(names, scanOptions, &manifest);
+    scanDirectory(scanner, pathToPictures);
+
+    {
+        std::lock_guard lock(mutex);
+        scanFinished = true;
+    }
+    condition.notify_all();
+
+    // Listing speed, to tune the threads for slow storage
+    const ScanStats& stats = scanner.getStats();
+    std::cout << "Found " << stats.files << " pictures in " << stats.directories
+              << " directories in " << stats.seconds << " s ("
+              << static_cast<std::size_t>(stats.filesPerSecond()) << " files/s, "
+              << stats.threads << " threads, " << stats.arenaBlocks << " arena blocks)" << std::endl;
+
+    // Directories, that appear later
+    while (true) {
+        std::string directory;
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() { return !directories.empty() || stopping; });
+
+            if (stopping)
+                return;
+
+            directory = std::move(directories.front());
+            directories.pop_front();
+        }
+
+        scanDirectory(scanner, directory);
+    }
+}
+
+
+void PictureLoader::process() {
+    // Statistics are needed for the first batch already
+    dataHandler.load();
+
+    while (true) {
+        std::vector<PictureRecord> batch;
+        bool initialScanDone = false;
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() {
+                return !discovered.empty() || stopping || (scanFinished && !finished);
+            });
+
+            if (stopping)
+                break;
+
+            // Nothing left of the initial scan
+            if (discovered.empty())
+                initialScanDone = true;
+            else {
+                batch = std::move(discovered.front());
+                discovered.pop_front();
+            }
+        }
+
+        if (initialScanDone) {
+            pictureHasher.save();
+            finished = true;
+            continue;
+        }
+
+        // Identify by content, then take the statistics
+        pictureHasher.hash(batch);
+        dataHandler.fill(batch);
+
+        std::lock_guard lock(readyMutex);
+        std::move(batch.begin(), batch.end(), std::back_inserter(ready));
+    }
+
+    pictureHasher.save();
+}
+
+
+void PictureLoader::add(std::vector<PictureRecord>&& pictures) {
+    {
+        std::lock_guard lock(mutex);
+        discovered.push_back(std::move(pictures));
+    }
+    condition.notify_all();
+}
+
+
+void PictureLoader::addDirectory(const std::string& directory) {
+    {
+        std::lock_guard lock(mutex);
+        directories.push_back(directory);
+    }
+    condition.notify_all();
+}
+
+
+bool PictureLoader::receive(std::vector<PictureRecord>& pictures) {
+    std::lock_guard lock(readyMutex);
+
+    if (ready.empty())
+        return false;
+
+    std::move(ready.begin(), ready.end(), std::back_inserter(pictures));
+    ready.clear();
+
+    return true;
+}
+
+
+bool PictureLoader::isFinished() const {
+    return finished;
+}
+
+
+void PictureLoader::stop() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    if (scanThread.joinable())
+        scanThread.join();
+
+    if (processThread.joinable())
+        processThread.join();
+}
+
+
+PictureLoader::~PictureLoader() {
+    stop();
+}
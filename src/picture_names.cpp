@@ -0,0 +1,144 @@
+#include "picture_names.hpp"
+
+// C++ standard libraries
+#include <cstring>
+
+
+PictureNames::PictureNames() :
+        next(nullptr),
+        blockLeft(0) {}
+
+
+char* PictureNames::allocate(std::uint32_t size, std::uint32_t& capacity) {
+    // The smallest free bytes, that fit
+    auto free = freeBytes.lower_bound(size);
+    if (free != freeBytes.end()) {
+        capacity = free->first;
+        char* bytes = free->second;
+        freeBytes.erase(free);
+        return bytes;
+    }
+
+    capacity = size;
+    if (size > blockLeft) {
+        // The current block keeps its space for shorter strings
+        if (size > blockSize) {
+            blocks.push_back(std::make_unique<char[]>(size));
+            return blocks.back().get();
+        }
+
+        blocks.push_back(std::make_unique<char[]>(blockSize));
+        next = blocks.back().get();
+        blockLeft = blockSize;
+    }
+
+    char* bytes = next;
+    next += size;
+    blockLeft -= size;
+    return bytes;
+}
+
+
+std::uint32_t PictureNames::intern(std::string_view directory) {
+    auto found = directoryIds.find(directory);
+    if (found != directoryIds.end())
+        return found->second;
+
+    std::uint32_t capacity;
+    char* bytes = allocate(directory.size(), capacity);
+    std::memcpy(bytes, directory.data(), directory.size());
+
+    std::string_view stored(bytes, directory.size());
+    directories.push_back(stored);
+    directoryIds.emplace(stored, directories.size() - 1);
+    return directories.size() - 1;
+}
+
+
+PictureNames::Entry PictureNames::getEntry(std::uint32_t file) const {
+    std::lock_guard lock(mutex);
+
+    return entries[file];
+}
+
+
+std::uint32_t PictureNames::add(std::string_view directory, std::string_view name) {
+    Entry entry{};
+    entry.size = name.size();
+
+    std::lock_guard lock(mutex);
+
+    entry.directory = intern(directory);
+
+    char* bytes = allocate(entry.size, entry.capacity);
+    std::memcpy(bytes, name.data(), name.size());
+    entry.name = bytes;
+
+    if (freeHandles.empty()) {
+        entries.push_back(entry);
+        return entries.size() - 1;
+    }
+
+    std::uint32_t file = freeHandles.back();
+    freeHandles.pop_back();
+    entries[file] = entry;
+    return file;
+}
+
+
+std::uint32_t PictureNames::add(std::string_view path) {
+    std::size_t slash = path.rfind('/');
+    if (slash == std::string_view::npos)
+        return add("", path);
+
+    // The root keeps its slash
+    return add(path.substr(0, slash == 0 ? 1 : slash), path.substr(slash + 1));
+}
+
+
+void PictureNames::remove(std::uint32_t file) {
+    std::lock_guard lock(mutex);
+
+    Entry& entry = entries[file];
+    if (entry.capacity != 0)
+        freeBytes.emplace(entry.capacity, const_cast<char*>(entry.name));
+
+    entry = Entry{};
+    freeHandles.push_back(file);
+}
+
+
+std::string_view PictureNames::getName(std::uint32_t file) const {
+    Entry entry = getEntry(file);
+    return std::string_view(entry.name, entry.size);
+}
+
+
+std::string_view PictureNames::getDirectory(std::uint32_t file) const {
+    std::lock_guard lock(mutex);
+
+    return directories[entries[file].directory];
+}
+
+
+std::string PictureNames::getPath(std::uint32_t file) const {
+    std::string_view directory = getDirectory(file);
+    std::string_view name = getName(file);
+
+    // Same as joining std::filesystem paths
+    std::string path;
+    path.reserve(directory.size() + 1 + name.size());
+    path.append(directory);
+    if (!directory.empty() && directory.back() != '/')
+        path.push_back('/');
+    path.append(name);
+
+    return path;
+}
+
+
+std::size_t PictureNames::size() const {
+    std::lock_guard lock(mutex);
+
+    return entries.size() - freeHandles.size();
+}
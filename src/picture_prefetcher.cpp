@@ -0,0 +1,162 @@
+#include "picture_prefetcher.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+
+
+PicturePrefetcher::PicturePrefetcher(std::size_t limit) :
+        limit(limit),
+        nextId(0),
+        stopping(false) {
+    thread = std::thread(&PicturePrefetcher::work, this);
+}
+
+
+void PicturePrefetcher::work() {
+    std::vector<std::uint64_t> ids;
+    std::vector<std::string> paths;
+    std::vector<std::vector<unsigned char>> buffers;
+    std::vector<bool> succeeded;
+
+    while (true) {
+        // Take every pending request //
+
+        ids.clear();
+        paths.clear();
+        buffers.clear();
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this]() {
+                return stopping || std::any_of(entries.begin(), entries.end(),
+                    [](const Entry& entry) { return entry.status == PrefetchStatus::PENDING && !entry.reading; });
+            });
+
+            if (stopping)
+                return;
+
+            for (auto& entry : entries) {
+                if (entry.status != PrefetchStatus::PENDING || entry.reading)
+                    continue;
+
+                entry.reading = true;
+                ids.push_back(entry.id);
+                paths.push_back(entry.path);
+
+                if (spare.empty())
+                    buffers.emplace_back();
+                else {
+                    buffers.push_back(std::move(spare.back()));
+                    spare.pop_back();
+                }
+            }
+        }
+
+        // Whole batch at once
+        io.read(paths, buffers, succeeded);
+
+        std::lock_guard lock(mutex);
+        for (std::size_t i = 0; i < ids.size(); i++) {
+            auto entry = std::find_if(entries.begin(), entries.end(),
+                [&](const Entry& entry) { return entry.id == ids[i]; });
+
+            // Nobody waits for it anymore
+            if (entry == entries.end()) {
+                spare.push_back(std::move(buffers[i]));
+                continue;
+            }
+
+            entry->data = std::move(buffers[i]);
+            entry->status = succeeded[i] ? PrefetchStatus::READY : PrefetchStatus::FAILED;
+        }
+
+        // Somebody may wait for the files
+        condition.notify_all();
+    }
+}
+
+
+void PicturePrefetcher::request(std::string_view path) {
+    {
+        std::lock_guard lock(mutex);
+
+        auto entry = std::find_if(entries.begin(), entries.end(),
+            [&](const Entry& entry) { return entry.path == path; });
+
+        if (entry != entries.end()) {
+            // Failed reads are tried again
+            if (entry->status != PrefetchStatus::FAILED)
+                return;
+
+            entry->status = PrefetchStatus::PENDING;
+            entry->reading = false;
+        }
+        else {
+            // Forget the oldest files, that are read already
+            while (entries.size() >= limit && entries.front().status != PrefetchStatus::PENDING) {
+                spare.push_back(std::move(entries.front().data));
+                entries.pop_front();
+            }
+
+            entries.push_back(Entry{nextId++, std::string(path), {}, PrefetchStatus::PENDING, false});
+        }
+    }
+    condition.notify_all();
+}
+
+
+PrefetchStatus PicturePrefetcher::getStatus(std::string_view path) {
+    std::lock_guard lock(mutex);
+
+    for (auto& entry : entries) {
+        if (entry.path == path)
+            return entry.status;
+    }
+
+    return PrefetchStatus::NONE;
+}
+
+
+void PicturePrefetcher::wait(std::string_view path) {
+    std::unique_lock lock(mutex);
+
+    condition.wait(lock, [&]() {
+        auto entry = std::find_if(entries.begin(), entries.end(),
+            [&](const Entry& entry) { return entry.path == path; });
+
+        return stopping || entry == entries.end() || entry->status != PrefetchStatus::PENDING;
+    });
+}
+
+
+bool PicturePrefetcher::take(std::string_view path, std::vector<unsigned char>& data) {
+    std::lock_guard lock(mutex);
+
+    auto entry = std::find_if(entries.begin(), entries.end(),
+        [&](const Entry& entry) { return entry.path == path; });
+
+    if (entry == entries.end() || entry->status == PrefetchStatus::PENDING)
+        return false;
+
+    if (entry->status == PrefetchStatus::FAILED) {
+        entries.erase(entry);
+        return false;
+    }
+
+    // Old contents go back to the pool
+    std::swap(entry->data, data);
+    spare.push_back(std::move(entry->data));
+    entries.erase(entry);
+
+    return true;
+}
+
+
+PicturePrefetcher::~PicturePrefetcher() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    thread.join();
+}
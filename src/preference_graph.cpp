@@ -0,0 +1,218 @@
+#include "preference_graph.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+#if defined(__AVX2__)
+// SIMD intrinsics
+#include <immintrin.h>
+#elif defined(__SSE2__)
+// SIMD intrinsics
+#include <emmintrin.h>
+#endif
+
+
+PreferenceGraph::PreferenceGraph() :
+        capacity(0),
+        words(0),
+        loaded(true) {}
+
+
+void PreferenceGraph::load(std::vector<std::pair<std::uint32_t, std::uint32_t>> votes) {
+    if (loader.joinable())
+        return;
+
+    loaded = false;
+    loader = std::thread(&PreferenceGraph::replay, this, std::move(votes));
+}
+
+
+void PreferenceGraph::wait() {
+    if (loader.joinable())
+        loader.join();
+}
+
+
+void PreferenceGraph::replay(std::vector<std::pair<std::uint32_t, std::uint32_t>> votes) {
+    PreferenceGraph history;
+    for (auto [winner, loser] : votes)
+        history.add(winner, loser, false);
+
+    std::lock_guard lock(mutex);
+    for (auto [winner, loser] : waiting)
+        history.add(winner, loser, true);
+    waiting.clear();
+
+    // Nothing else touches the closure until loaded
+    capacity = history.capacity;
+    words = history.words;
+    worse = std::move(history.worse);
+    better = std::move(history.better);
+    beaten = std::move(history.beaten);
+    contradictions = std::move(history.contradictions);
+    loaded = true;
+}
+
+
+void PreferenceGraph::reserve(std::uint32_t id) {
+    if (id < capacity)
+        return;
+
+    // Rows are a multiple of 256 bits, a whole AVX2 register
+    std::size_t grown = std::max<std::size_t>(capacity, 256);
+    while (grown <= id)
+        grown *= 2;
+
+    std::size_t grownWords = grown / 64;
+    std::vector<std::uint64_t> grownWorse(grown * grownWords, 0);
+    std::vector<std::uint64_t> grownBetter(grown * grownWords, 0);
+
+    for (std::size_t row = 0; row < capacity; row++) {
+        std::copy_n(&worse[row * words], words, &grownWorse[row * grownWords]);
+        std::copy_n(&better[row * words], words, &grownBetter[row * grownWords]);
+    }
+
+    worse = std::move(grownWorse);
+    better = std::move(grownBetter);
+    beaten.resize(grown);
+    capacity = grown;
+    words = grownWords;
+}
+
+
+bool PreferenceGraph::test(const std::uint64_t* row, std::uint32_t id) {
+    return (row[id / 64] >> (id % 64)) & 1;
+}
+
+
+void PreferenceGraph::orRow(std::uint64_t* destination, const std::uint64_t* source, std::size_t words) {
+#if defined(__AVX2__)
+    for (std::size_t i = 0; i < words; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_or_si256(a, b));
+    }
+#elif defined(__SSE2__)
+    for (std::size_t i = 0; i < words; i += 2) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_or_si128(a, b));
+    }
+#else
+    for (std::size_t i = 0; i < words; i++)
+        destination[i] |= source[i];
+#endif
+}
+
+
+void PreferenceGraph::record(std::uint32_t winner, std::uint32_t loser) {
+    if (!loaded) {
+        std::lock_guard lock(mutex);
+        if (!loaded) {
+            waiting.emplace_back(winner, loser);
+            return;
+        }
+    }
+
+    add(winner, loser, true);
+}
+
+
+void PreferenceGraph::add(std::uint32_t winner, std::uint32_t loser, bool queueCycles) {
+    if (winner >= maxPictures || loser >= maxPictures || winner == loser)
+        return;
+
+    reserve(std::max(winner, loser));
+    beaten[winner].push_back(loser);
+
+    // Known already
+    if (test(&worse[winner * words], loser))
+        return;
+
+    bool cycle = test(&worse[loser * words], winner);
+
+    // Winner with everything better, loser with everything worse
+    std::vector<std::uint64_t> above(&better[winner * words], &better[winner * words] + words);
+    std::vector<std::uint64_t> below(&worse[loser * words], &worse[loser * words] + words);
+    above[winner / 64] |= std::uint64_t(1) << (winner % 64);
+    below[loser / 64] |= std::uint64_t(1) << (loser % 64);
+
+    for (std::size_t word = 0; word < words; word++) {
+        for (std::uint64_t bits = above[word]; bits; bits &= bits - 1)
+            orRow(&worse[(word * 64 + std::countr_zero(bits)) * words], below.data(), words);
+
+        for (std::uint64_t bits = below[word]; bits; bits &= bits - 1)
+            orRow(&better[(word * 64 + std::countr_zero(bits)) * words], above.data(), words);
+    }
+
+    if (cycle && queueCycles)
+        findCycle(winner, loser);
+}
+
+
+void PreferenceGraph::findCycle(std::uint32_t winner, std::uint32_t loser) {
+    // The component of the winner: better and worse than it at once
+    const std::uint64_t* worseRow = &worse[winner * words];
+    const std::uint64_t* betterRow = &better[winner * words];
+
+    auto inComponent = [&](std::uint32_t id) {
+        return id == winner || (test(worseRow, id) && test(betterRow, id));
+    };
+
+    // Shortest chain of votes from the loser back to the winner
+    std::unordered_map<std::uint32_t, std::uint32_t> previous{{loser, loser}};
+    std::deque<std::uint32_t> queue{loser};
+
+    while (!queue.empty() && !previous.contains(winner)) {
+        std::uint32_t current = queue.front();
+        queue.pop_front();
+
+        for (auto next : beaten[current]) {
+            if (inComponent(next) && previous.try_emplace(next, current).second)
+                queue.push_back(next);
+        }
+    }
+
+    if (!previous.contains(winner))
+        return;
+
+    for (std::uint32_t current = winner; current != loser; current = previous[current]) {
+        contradictions.emplace_back(previous[current], current);
+
+        if (contradictions.size() > maxContradictions)
+            contradictions.pop_front();
+    }
+}
+
+
+bool PreferenceGraph::implies(std::uint32_t first, std::uint32_t second) const {
+    if (!loaded || first >= capacity || second >= capacity)
+        return false;
+
+    return test(&worse[first * words], second) != test(&worse[second * words], first);
+}
+
+
+bool PreferenceGraph::contradicts(std::uint32_t first, std::uint32_t second) const {
+    if (!loaded || first >= capacity || second >= capacity)
+        return false;
+
+    return test(&worse[first * words], second) && test(&worse[second * words], first);
+}
+
+
+bool PreferenceGraph::takeContradiction(std::uint32_t& first, std::uint32_t& second) {
+    if (!loaded || contradictions.empty())
+        return false;
+
+    std::tie(first, second) = contradictions.front();
+    contradictions.pop_front();
+    return true;
+}
+
+
+PreferenceGraph::~PreferenceGraph() {
+    wait();
+}
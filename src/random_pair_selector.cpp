@@ -0,0 +1,61 @@
+#include "random_pair_selector.hpp"
+
+
+RandomPairSelector::RandomPairSelector(std::uint32_t seed) : gen(seed) {}
+
+
+double RandomPairSelector::weight(const PictureRecord& picture) {
+    return picture.removed ? 0.0 : 1.0 / (1.0 + picture.total);
+}
+
+
+void RandomPairSelector::synchronize(const std::vector<PictureRecord>& pictures) {
+    for (std::size_t i = sampler.size(); i < pictures.size(); i++)
+        sampler.push(weight(pictures[i]));
+}
+
+
+std::size_t RandomPairSelector::draw(const std::vector<PictureRecord>& pictures) {
+    // Removed pictures keep their weight until drawn
+    for (int attempt = 0; attempt < 64; attempt++) {
+        std::size_t index = sampler.sample(gen);
+        if (index >= pictures.size() || !pictures[index].removed)
+            return index;
+
+        sampler.set(index, 0.0);
+    }
+
+    return pictures.size();
+}
+
+
+bool RandomPairSelector::choose(const std::vector<PictureRecord>& pictures, const Filter& accept,
+                                    std::size_t& left, std::size_t& right) {
+    synchronize(pictures);
+
+    if (pictures.size() < 2)
+        return false;
+
+    // Rejected pairs are skipped. A few attempts are enough,
+    // unless almost everything is rejected
+    for (int attempt = 0; attempt < 64; attempt++) {
+        left = draw(pictures);
+        right = draw(pictures);
+
+        if (left >= pictures.size() || right >= pictures.size())
+            return false;
+
+        if (left != right && accept(left, right))
+            return true;
+    }
+
+    return false;
+}
+
+
+void RandomPairSelector::record(const std::vector<PictureRecord>& pictures, std::size_t winner, std::size_t loser) {
+    synchronize(pictures);
+
+    sampler.set(winner, weight(pictures[winner]));
+    sampler.set(loser, weight(pictures[loser]));
+}
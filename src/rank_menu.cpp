@@ -4,6 +4,8 @@
 #include "menu_events.hpp"
 #include "picture_record.hpp"
 #include "transition_state.hpp"
+#include "ranking.hpp"
+#include "picture_decoder.hpp"
 
 // C++ standard libraries
 #include <iomanip>
@@ -11,13 +13,18 @@
 #include <sstream>
 
 // SDL libraries
-#include <SDL2/SDL_image.h>
 #include <SDL_ttf.h>
 
 
-RankMenu::RankMenu(Screen& screen, std::vector<PictureRecord>& pictures, std::string pathToFont) : 
+RankMenu::RankMenu(Screen& screen, const std::vector<PictureRecord>& pictures, const PictureNames& pictureNames,
+                    std::vector<std::uint32_t> order, SortKey& sortKey,
+                    const ConvergenceTracker& convergenceTracker, std::string pathToFont) : 
         pictures(pictures), 
+        pictureNames(pictureNames),
+        order(std::move(order)),
         index(0),
+        sortKey(sortKey),
+        convergenceTracker(convergenceTracker),
         transitionState(TransitionState::FADE_IN),
         displacement(1.0f),
         nameFont(20),
@@ -28,10 +35,14 @@ RankMenu::RankMenu(Screen& screen, std::vector<PictureRecord>& pictures, std::st
         winsTexture(nullptr),
         winrateTexture(nullptr),
         totalTexture(nullptr),
-        pictureTexture(nullptr) {
+        ratingTexture(nullptr),
+        convergenceTexture(nullptr),
+        pictureTexture(nullptr),
+        pictureLoaded(false) {
     
     // Load all the information needed
     loadEntities(screen);
+    loadConvergence(screen);
 
     // Start the logic of the menu
     startTransition(TransitionState::FADE_IN);
@@ -45,56 +56,159 @@ void RankMenu::loadEntities(Screen& screen) {
     loadWins(screen);
     loadWinrate(screen);
     loadTotal(screen);
+    loadRating(screen);
+}
+
+
+const PictureRecord& RankMenu::getPicture() const {
+    return pictures[order[index]];
 }
 
 
 void RankMenu::loadName(Screen& screen) {
-    loadLabel(screen, &nameTexture, pictures[index].name);
+    loadLabel(screen, &nameTexture, std::string(pictureNames.getName(getPicture().file)));
+}
+
+
+int RankMenu::getNeighbour(int step) const {
+    // Removed pictures are skipped
+    int neighbour = index + step;
+    while (neighbour >= 0 && neighbour < static_cast<int>(order.size()) && pictures[order[neighbour]].removed)
+        neighbour += step;
+
+    if (neighbour < 0 || neighbour >= static_cast<int>(order.size()))
+        return -1;
+
+    return neighbour;
+}
+
+
+void RankMenu::prefetchAround() {
+    prefetcher.request(pictureNames.getPath(getPicture().file));
+
+    for (int step : {-1, 1}) {
+        int neighbour = getNeighbour(step);
+        if (neighbour != -1)
+            prefetcher.request(pictureNames.getPath(pictures[order[neighbour]].file));
+    }
 }
 
 
 void RankMenu::loadPicture(Screen& screen) {
     // if needed, free the pictures
     freeTexture(&pictureTexture);
+    pictureLoaded = false;
 
-    SDL_Surface* temp = IMG_Load(pictures[index].path.c_str());
-    pictureTexture = screen.toTexture(temp);
-    SDL_FreeSurface(temp);
+    prefetchAround();
+    receivePicture(screen);
+}
+
+
+void RankMenu::receivePicture(Screen& screen) {
+    if (pictureLoaded)
+        return;
+
+    std::string path = pictureNames.getPath(getPicture().file);
+    PrefetchStatus status = prefetcher.getStatus(path);
+
+    // Forgotten to make room, read again
+    if (status == PrefetchStatus::NONE)
+        prefetcher.request(path);
+
+    // Check on the next frame
+    if (status == PrefetchStatus::NONE || status == PrefetchStatus::PENDING)
+        return;
+
+    // A file, that cannot be read, leaves the box empty
+    SDL_Surface* temp = prefetcher.take(path, pictureBytes) ? PictureDecoder::decode(pictureBytes) : nullptr;
+    if (temp) {
+        pictureTexture = screen.toTexture(temp);
+        SDL_FreeSurface(temp);
+
+        // Arrived in the middle of a transition
+        if (transitionState != TransitionState::NONE)
+            SDL_SetTextureBlendMode(pictureTexture, SDL_BLENDMODE_BLEND);
+    }
+
+    pictureLoaded = true;
 }
 
 
 void RankMenu::loadIndex(Screen& screen) {
-    indexText = "#" + std::to_string(index + 1);
+    indexText = "#" + std::to_string(index + 1) + " by " + Ranking::name(sortKey);
     loadLabel(screen, &indexTexture, indexText);
 }
 
 
 void RankMenu::loadWins(Screen& screen) {
-    winsText = "Wins: " + std::to_string(pictures[index].wins);
+    winsText = "Wins: " + std::to_string(getPicture().wins);
     loadLabel(screen, &winsTexture, winsText);
 }
 
 void RankMenu::loadWinrate(Screen& screen) {
     // Calculating winrate
     float winrate;
-    if (pictures[index].total == 0)
+    if (getPicture().total == 0)
         winrate = 0;
     else
-        winrate = 100.0f * pictures[index].wins / pictures[index].total;
+        winrate = 100.0f * getPicture().wins / getPicture().total;
     
     std::stringstream ss;
     ss << "Winrate: " << std::fixed << std::setprecision(2) << winrate << " %";
+
+    // With the adjusted winrate, the picture is ranked by
+    const PictureRecord& picture = getPicture();
+    if (sortKey == SortKey::WILSON)
+        ss << ", at least " << 100.0 * Ranking::wilson(picture.wins, picture.total) << " %";
+    else if (sortKey == SortKey::BAYES)
+        ss << ", adjusted " << 100.0 * Ranking::bayes(picture.wins, picture.total) << " %";
+
     winrateText = ss.str();
     loadLabel(screen, &winrateTexture, winrateText);
 }
 
 
 void RankMenu::loadTotal(Screen& screen) {
-    totalText = "Total: " + std::to_string(pictures[index].total);
+    totalText = "Total: " + std::to_string(getPicture().total);
     loadLabel(screen, &totalTexture, totalText);
 }
 
 
+void RankMenu::loadRating(Screen& screen) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(0);
+
+    // Glicko comes with its 95% interval
+    if (sortKey == SortKey::GLICKO)
+        ss << "Glicko: " << getPicture().glicko << " +- " << 2 * getPicture().deviation;
+    else
+        ss << "Elo: " << getPicture().elo;
+
+    ratingText = ss.str();
+    loadLabel(screen, &ratingTexture, ratingText);
+}
+
+
+void RankMenu::loadConvergence(Screen& screen) {
+    std::stringstream ss;
+    std::size_t window = convergenceTracker.getWindow();
+
+    if (!convergenceTracker.isReady()) {
+        ss << "Convergence is known in " << convergenceTracker.getVotesLeft() << " votes";
+    }
+    else {
+        // Compared with the ranking a window of votes ago
+        ss << "Last " << window << " votes: Kendall tau " << std::fixed << std::setprecision(3)
+            << convergenceTracker.getTau() << ", top " << convergenceTracker.getTopCount()
+            << " kept " << convergenceTracker.getTopKept() << ", mean RD "
+            << std::setprecision(0) << convergenceTracker.getMeanDeviation();
+    }
+
+    convergenceText = ss.str();
+    loadLabel(screen, &convergenceTexture, convergenceText);
+}
+
+
 void RankMenu::loadLabel(Screen& screen, SDL_Texture** tempTexture, const std::string& toShow) {
     // free label if needed
     freeTexture(tempTexture);
@@ -129,14 +243,16 @@ void RankMenu::freeEntities() {
     freeTexture(&winsTexture);
     freeTexture(&winrateTexture);
     freeTexture(&totalTexture);
+    freeTexture(&ratingTexture);
+    freeTexture(&convergenceTexture);
 }
 
 
-MenuEvent RankMenu::handleEvents(Screen& screen) {
+MenuEvent RankMenu::handleEvents(Screen& screen, EventSource& events) {
     if (transitionState == TransitionState::END)
         return toReturn;
 
-    return BaseMenu::handleEvents(screen);
+    return BaseMenu::handleEvents(screen, events);
 }
 
 MenuEvent RankMenu::handleSpecificEvent(const SDL_Event &event, Screen &screen) {
@@ -147,6 +263,13 @@ MenuEvent RankMenu::handleSpecificEvent(const SDL_Event &event, Screen &screen)
                 toReturn = MenuEvent::TO_MAIN_SCREEN;
                 startTransition(TransitionState::FADE_OUT);
             }
+            else if (event.key.keysym.scancode == SDL_SCANCODE_TAB &&
+                    transitionState == TransitionState::NONE) {
+                // The application takes the order of the key and reopens the menu
+                sortKey = Ranking::next(sortKey);
+                toReturn = MenuEvent::TO_RATING_SCREEN;
+                startTransition(TransitionState::FADE_OUT);
+            }
             else if (event.key.keysym.scancode == SDL_SCANCODE_LEFT &&
                     transitionState == TransitionState::NONE) {
                 toLeft();
@@ -163,7 +286,7 @@ MenuEvent RankMenu::handleSpecificEvent(const SDL_Event &event, Screen &screen)
 
 
 bool RankMenu::toUpdate() {
-    return transitionState != TransitionState::NONE;
+    return transitionState != TransitionState::NONE || !pictureLoaded;
 }
 
 
@@ -171,13 +294,11 @@ void RankMenu::toLeft() {
     // No way to move left:
     // The best picture is displayed
     // according to ranking
-    if (index <= 0) {
-        index = 0;
+    int previous = getNeighbour(-1);
+    if (previous < 0)
         return;
-    }
 
-    // Safety measure
-    index = std::max(0, index - 1);
+    index = previous;
 
     startTransition(TransitionState::LEFT_OUT);
 }
@@ -187,13 +308,11 @@ void RankMenu::toRight() {
     // No way to move right:
     // The worst picture is displayed
     // according to ranking
-    if (index >= pictures.size() - 1) {
-        index = pictures.size() - 1;
+    int next = getNeighbour(1);
+    if (next < 0)
         return;
-    }
 
-    // Safety measure
-    index = std::min(static_cast<int>(pictures.size() - 1), index + 1);
+    index = next;
 
     // Setup transition
     startTransition(TransitionState::RIGHT_OUT);
@@ -280,6 +399,7 @@ void RankMenu::updateTransitionDefaultIn() {
         t = 1 - (transitionProgress - 0.66f) / 0.33f;
 
         totalRect.y += acceleration * t * t / 2;
+        ratingRect.y += acceleration * t * t / 2;
     }
 }
 
@@ -370,6 +490,7 @@ void RankMenu::updateTransitionDefaultOut() {
         t = (transitionProgress - 0.66f) / 0.33f;
 
         totalRect.x += acceleration * t * t / 2;
+        ratingRect.x += acceleration * t * t / 2;
     }
 }
 
@@ -397,17 +518,21 @@ void RankMenu::update(Screen &screen) {
     boxW = static_cast<int>(500.0f / 1280 * windowX); 
     boxH = static_cast<int>(500.0f / 720 * windowY);
 
+    // The file may have been read since the last frame
+    receivePicture(screen);
+
     // Name label
     nameRect.y = 10;
-    nameRect.w = nameFont * pictures[index].name.size();
+    nameRect.w = nameFont * pictureNames.getName(getPicture().file).size();
     nameRect.h = static_cast<int>(2.4 * nameFont);
     nameRect.x = windowX / 2 - nameRect.w / 2;
     
     // Picture //
 
-    // Size of picture
-    int imgWW, imgH;
-    SDL_QueryTexture(pictureTexture, NULL, NULL, &imgWW, &imgH);
+    // Size of picture, the box until it is read
+    int imgWW = boxW, imgH = boxH;
+    if (pictureTexture)
+        SDL_QueryTexture(pictureTexture, NULL, NULL, &imgWW, &imgH);
     
     float ratio = 1.0f * imgWW / imgH;
     float ratioBox = 1.0f * boxW / boxH;
@@ -473,6 +598,22 @@ void RankMenu::update(Screen &screen) {
         static_cast<int>(2.4f * otherFont)
     };
 
+    // Rating position
+    ratingRect = SDL_Rect {
+        borders.x + borders.w + 20,
+        totalRect.y + totalRect.h + 5,
+        static_cast<int>(otherFont * ratingText.size()),
+        static_cast<int>(2.4f * otherFont)
+    };
+
+    // Convergence position, under the picture
+    convergenceRect = SDL_Rect {
+        static_cast<int>(windowX / 2 - otherFont * convergenceText.size() / 2),
+        windowY - static_cast<int>(2.4f * otherFont) - 10,
+        static_cast<int>(otherFont * convergenceText.size()),
+        static_cast<int>(2.4f * otherFont)
+    };
+
     // In case of changes
     auto previousState = transitionState;
 
@@ -515,6 +656,9 @@ void RankMenu::renderTransitionIn() {
     SDL_SetTextureAlphaMod(pictureTexture, static_cast<int>(transitionProgress * 255));
 
     if (transitionState == TransitionState::FADE_IN) {
+        // Stays, while pictures change
+        SDL_SetTextureAlphaMod(convergenceTexture, static_cast<int>(transitionProgress * 255));
+
         // If last transition in - order of fading
 
         if (transitionProgress <= 0.25f) {
@@ -541,10 +685,12 @@ void RankMenu::renderTransitionIn() {
             // 0.0 - 0.66
             // Transparent
             SDL_SetTextureAlphaMod(totalTexture, 0);
+            SDL_SetTextureAlphaMod(ratingTexture, 0);
         }
         else {
             // 0.67 - 1.0
             SDL_SetTextureAlphaMod(totalTexture, static_cast<int>((transitionProgress - 0.66f) / 0.33f * 255));
+            SDL_SetTextureAlphaMod(ratingTexture, static_cast<int>((transitionProgress - 0.66f) / 0.33f * 255));
         }
 
     }
@@ -555,6 +701,7 @@ void RankMenu::renderTransitionIn() {
         SDL_SetTextureAlphaMod(winsTexture, static_cast<int>(transitionProgress * 255));
         SDL_SetTextureAlphaMod(winrateTexture, static_cast<int>(transitionProgress * 255));
         SDL_SetTextureAlphaMod(totalTexture, static_cast<int>(transitionProgress * 255));
+        SDL_SetTextureAlphaMod(ratingTexture, static_cast<int>(transitionProgress * 255));
     }
 
 
@@ -572,6 +719,9 @@ void RankMenu::renderTransitionOut() {
     SDL_SetTextureAlphaMod(pictureTexture, 255 - static_cast<int>(transitionProgress * 255));
 
     if (transitionState == TransitionState::FADE_OUT) {
+        // Stays, while pictures change
+        SDL_SetTextureAlphaMod(convergenceTexture, 255 - static_cast<int>(transitionProgress * 255));
+
         // If last fade out - order of fading
 
         if (transitionProgress <= 0.25f) {
@@ -613,10 +763,12 @@ void RankMenu::renderTransitionOut() {
             //  0.0 - 0.66
             // Full opacity
             SDL_SetTextureAlphaMod(totalTexture, 255);
+            SDL_SetTextureAlphaMod(ratingTexture, 255);
         }
         else {
             // 0.67 - 1.0
             SDL_SetTextureAlphaMod(totalTexture, 255 - static_cast<int>((transitionProgress - 0.66f) / 0.33f * 255));
+            SDL_SetTextureAlphaMod(ratingTexture, 255 - static_cast<int>((transitionProgress - 0.66f) / 0.33f * 255));
         }
     }
     else {
@@ -626,6 +778,7 @@ void RankMenu::renderTransitionOut() {
         SDL_SetTextureAlphaMod(winsTexture, 255 - static_cast<int>(transitionProgress * 255));
         SDL_SetTextureAlphaMod(winrateTexture, 255 - static_cast<int>(transitionProgress * 255));
         SDL_SetTextureAlphaMod(totalTexture, 255 - static_cast<int>(transitionProgress * 255));
+        SDL_SetTextureAlphaMod(ratingTexture, 255 - static_cast<int>(transitionProgress * 255));
     }
 
 }
@@ -686,15 +839,35 @@ void RankMenu::render(Screen& screen) {
         totalTexture
     );
 
-    // Picture
+    // Rating
+    screen.putTexturedRect(
+        ratingRect.x, 
+        ratingRect.y, 
+        ratingRect.w, 
+        ratingRect.h, 
+        ratingTexture
+    );
+
+    // Convergence
     screen.putTexturedRect(
-        pictureRect.x, 
-        pictureRect.y, 
-        pictureRect.w,
-        pictureRect.h,
-        pictureTexture
+        convergenceRect.x, 
+        convergenceRect.y, 
+        convergenceRect.w, 
+        convergenceRect.h, 
+        convergenceTexture
     );
 
+    // Picture, once its file is read
+    if (pictureTexture) {
+        screen.putTexturedRect(
+            pictureRect.x, 
+            pictureRect.y, 
+            pictureRect.w,
+            pictureRect.h,
+            pictureTexture
+        );
+    }
+
     // Borders of picture
     screen.putRect(
         borders.x,
@@ -0,0 +1,111 @@
+#include "ranking.hpp"
+
+// Custom libraries
+#include "glicko_rating.hpp"
+
+// C++ standard libraries
+#include <cmath>
+
+
+// Normal quantile of the 95% interval
+static constexpr double wilsonZ = 1.96;
+
+// Votes of the prior, each won half of the time.
+// Every vote has one winner, so the mean winrate is exactly 50%
+static constexpr double bayesVotes = 10.0;
+
+
+double Ranking::score(const PictureRecord& picture, SortKey key) {
+    switch (key) {
+        case SortKey::ELO:
+            return picture.elo;
+
+        // Uncertain ratings are not trusted
+        case SortKey::GLICKO:
+            return GlickoRating::conservative(picture);
+
+        case SortKey::WILSON:
+            return wilson(picture.wins, picture.total);
+
+        case SortKey::BAYES:
+            return bayes(picture.wins, picture.total);
+
+        case SortKey::WINS:
+        default:
+            return picture.wins;
+    }
+}
+
+
+double Ranking::wilson(std::size_t wins, std::size_t total) {
+    if (total == 0)
+        return 0.0;
+
+    double n = total;
+    double p = wins / n;
+    double z2 = wilsonZ * wilsonZ;
+
+    double center = p + z2 / (2 * n);
+    double spread = wilsonZ * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n));
+
+    return (center - spread) / (1 + z2 / n);
+}
+
+
+double Ranking::bayes(std::size_t wins, std::size_t total) {
+    return (wins + bayesVotes / 2) / (total + bayesVotes);
+}
+
+
+std::string Ranking::name(SortKey key) {
+    switch (key) {
+        case SortKey::ELO:
+            return "Elo";
+
+        case SortKey::GLICKO:
+            return "Glicko";
+
+        case SortKey::WILSON:
+            return "Wilson";
+
+        case SortKey::BAYES:
+            return "Bayes";
+
+        case SortKey::SORT:
+            return "Sort";
+
+        case SortKey::TOP:
+            return "Top";
+
+        case SortKey::WINS:
+        default:
+            return "Wins";
+    }
+}
+
+
+SortKey Ranking::next(SortKey key) {
+    switch (key) {
+        case SortKey::WINS:
+            return SortKey::ELO;
+
+        case SortKey::ELO:
+            return SortKey::GLICKO;
+
+        case SortKey::GLICKO:
+            return SortKey::WILSON;
+
+        case SortKey::WILSON:
+            return SortKey::BAYES;
+
+        case SortKey::BAYES:
+            return SortKey::SORT;
+
+        case SortKey::SORT:
+            return SortKey::TOP;
+
+        case SortKey::TOP:
+        default:
+            return SortKey::WINS;
+    }
+}
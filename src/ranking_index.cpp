@@ -0,0 +1,79 @@
+#include "ranking_index.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <iterator>
+
+
+bool RankingIndex::Entry::operator<(const Entry& other) const {
+    if (removed != other.removed)
+        return other.removed;
+
+    if (score != other.score)
+        return score > other.score;
+
+    return index < other.index;
+}
+
+
+void RankingIndex::touch(std::size_t index) {
+    changed.push_back(index);
+}
+
+
+void RankingIndex::refresh(const std::vector<PictureRecord>& pictures) {
+    if (changed.empty())
+        return;
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    // Old entries of changed pictures are dropped
+    std::vector<char> isChanged(pictures.size(), 0);
+    for (auto index : changed)
+        isChanged[index] = 1;
+
+    for (std::size_t key = 0; key < Ranking::keyCount; key++) {
+        std::vector<Entry> fresh;
+        fresh.reserve(changed.size());
+        for (auto index : changed) {
+            const PictureRecord& picture = pictures[index];
+            fresh.push_back(Entry{
+                Ranking::score(picture, static_cast<SortKey>(key)),
+                static_cast<std::uint32_t>(index),
+                picture.removed
+            });
+        }
+        std::sort(fresh.begin(), fresh.end());
+
+        std::vector<Entry>& order = orders[key];
+        std::vector<Entry> merged;
+        merged.reserve(order.size() + fresh.size());
+
+        // Merge of the unchanged with the fresh ones
+        auto freshIt = fresh.begin();
+        for (auto& entry : order) {
+            if (isChanged[entry.index])
+                continue;
+
+            while (freshIt != fresh.end() && *freshIt < entry)
+                merged.push_back(*freshIt++);
+            merged.push_back(entry);
+        }
+        merged.insert(merged.end(), freshIt, fresh.end());
+
+        order = std::move(merged);
+    }
+
+    changed.clear();
+}
+
+
+void RankingIndex::getOrder(SortKey key, std::vector<std::uint32_t>& order) const {
+    const std::vector<Entry>& entries = orders[static_cast<std::size_t>(key)];
+
+    order.clear();
+    order.reserve(entries.size());
+    std::transform(entries.begin(), entries.end(), std::back_inserter(order),
+        [](const Entry& entry) { return entry.index; });
+}
@@ -0,0 +1,238 @@
+#include "scan_manifest.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+// POSIX libraries
+#include <sys/stat.h>
+
+
+// "RMF3", older manifests are rebuilt
+static constexpr std::uint32_t manifestMagic = 0x33464d52;
+
+
+template<typename T>
+static void writeRaw(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+static void writeString(std::ostream& out, std::string_view value) {
+    writeRaw<std::uint32_t>(out, value.size());
+    out.write(value.data(), value.size());
+}
+
+
+template<typename T>
+static bool readRaw(const char*& it, const char* end, T& value) {
+    if (end - it < static_cast<std::ptrdiff_t>(sizeof(T)))
+        return false;
+
+    std::memcpy(&value, it, sizeof(T));
+    it += sizeof(T);
+    return true;
+}
+
+
+static bool readString(const char*& it, const char* end, std::string& value) {
+    std::uint32_t length;
+    if (!readRaw(it, end, length) || end - it < length)
+        return false;
+
+    value.assign(it, length);
+    it += length;
+    return true;
+}
+
+
+// Calls f for every name of the list, each name ends with '\0'
+template<typename F>
+static void forEachName(std::string_view names, F f) {
+    while (!names.empty()) {
+        std::size_t end = names.find('\0');
+        f(names.substr(0, end));
+        names.remove_prefix(end + 1);
+    }
+}
+
+
+ScanManifest::ScanManifest(std::string path) :
+        path(path + "/manifest.bin"),
+        modified(false) {
+    load();
+}
+
+
+void ScanManifest::load() {
+    // Read the file at once, then parse from memory
+    std::ifstream file(path, std::ios::binary);
+    std::string data(std::istreambuf_iterator<char>(file), {});
+
+    const char* it = data.data();
+    const char* end = data.data() + data.size();
+
+    std::uint32_t magic, directoryCount;
+    if (!readRaw(it, end, magic) || magic != manifestMagic || !readRaw(it, end, directoryCount))
+        return;
+
+    directories.reserve(directoryCount);
+
+    // A damaged tail is ignored, those directories are listed again
+    for (std::uint32_t i = 0; i < directoryCount; i++) {
+        std::string directory;
+        DirectoryEntry entry;
+        std::uint32_t subdirectoryCount, fileCount;
+
+        if (!readString(it, end, directory) || !readRaw(it, end, entry.mtime) ||
+                !readRaw(it, end, subdirectoryCount))
+            return;
+
+        std::string name;
+        for (std::uint32_t j = 0; j < subdirectoryCount; j++) {
+            if (!readString(it, end, name))
+                return;
+
+            entry.subdirectories.append(name).push_back('\0');
+        }
+
+        if (!readRaw(it, end, fileCount))
+            return;
+
+        for (std::uint32_t j = 0; j < fileCount; j++) {
+            FileEntry file;
+
+            if (!readString(it, end, name) || !readRaw(it, end, file.size) ||
+                    !readRaw(it, end, file.mtime) || !readRaw(it, end, file.hash) ||
+                    !readRaw(it, end, file.perceptual))
+                return;
+
+            // Files not hashed yet are only listed
+            entry.files.append(name).push_back('\0');
+            if (file.hash != 0)
+                files[(std::filesystem::path(directory) / name).string()] = file;
+        }
+
+        directories[directory] = std::move(entry);
+    }
+}
+
+
+bool ScanManifest::restore(const std::string& directory, std::int64_t mtime, PictureNames& names,
+                            std::vector<PictureRecord>& pictures, std::vector<std::string>& subdirectories) {
+    std::lock_guard lock(mutex);
+
+    auto found = directories.find(directory);
+    if (found == directories.end() || found->second.mtime != mtime || mtime == -1)
+        return false;
+
+    visited.insert(directory);
+
+    forEachName(found->second.subdirectories, [&](std::string_view subdirectory) {
+        subdirectories.push_back((std::filesystem::path(directory) / subdirectory).string());
+    });
+
+    // Files may be edited in place, so hashes come
+    // from the cache only after a stat by the hasher
+    forEachName(found->second.files, [&](std::string_view name) {
+        pictures.push_back(PictureRecord{.file = names.add(directory, name)});
+    });
+
+    return true;
+}
+
+
+void ScanManifest::updateDirectory(const std::string& directory, std::int64_t mtime,
+                                    std::string_view subdirectories, std::string_view pictures) {
+    std::lock_guard lock(mutex);
+
+    visited.insert(directory);
+    directories[directory] = DirectoryEntry{mtime, std::string(subdirectories), std::string(pictures)};
+    modified = true;
+}
+
+
+bool ScanManifest::findFile(const std::string& filePath, FileEntry& entry) const {
+    std::lock_guard lock(mutex);
+
+    auto found = files.find(filePath);
+    if (found == files.end())
+        return false;
+
+    entry = found->second;
+    return true;
+}
+
+
+void ScanManifest::updateFile(const std::string& filePath, const FileEntry& entry) {
+    std::lock_guard lock(mutex);
+
+    files[filePath] = entry;
+    modified = true;
+}
+
+
+void ScanManifest::save() {
+    std::lock_guard lock(mutex);
+
+    if (!modified)
+        return;
+
+    // Written aside and renamed, so a crash never leaves half a manifest
+    std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary);
+
+    // Only directories seen in this run
+    writeRaw<std::uint32_t>(file, manifestMagic);
+    writeRaw<std::uint32_t>(file, visited.size());
+
+    for (auto& directory : visited) {
+        const DirectoryEntry& entry = directories[directory];
+
+        writeString(file, directory);
+        writeRaw(file, entry.mtime);
+
+        writeRaw<std::uint32_t>(file, std::count(entry.subdirectories.begin(), entry.subdirectories.end(), '\0'));
+        forEachName(entry.subdirectories, [&file](std::string_view subdirectory) {
+            writeString(file, subdirectory);
+        });
+
+        // Every file of the listing, so restore() gives all of them. Files,
+        // that are not hashed yet, have hash 0 and are hashed next time
+        static constexpr FileEntry unhashed{0, -1, 0, 0};
+
+        writeRaw<std::uint32_t>(file, std::count(entry.files.begin(), entry.files.end(), '\0'));
+        forEachName(entry.files, [&](std::string_view name) {
+            auto found = files.find((std::filesystem::path(directory) / name).string());
+            const FileEntry& fileEntry = found != files.end() ? found->second : unhashed;
+
+            writeString(file, name);
+            writeRaw(file, fileEntry.size);
+            writeRaw(file, fileEntry.mtime);
+            writeRaw(file, fileEntry.hash);
+            writeRaw(file, fileEntry.perceptual);
+        });
+    }
+
+    file.close();
+    if (!file || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cout << "Could not save " << path << std::endl;
+        return;
+    }
+
+    modified = false;
+}
+
+
+std::int64_t ScanManifest::modificationTime(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) == -1)
+        return -1;
+
+    return info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+}
@@ -0,0 +1,79 @@
+#include "schedule_pair_selector.hpp"
+
+
+SchedulePairSelector::SchedulePairSelector(ComparisonSchedule& schedule, std::uint32_t seed) :
+        schedule(schedule),
+        random(seed),
+        gen(seed) {}
+
+
+void SchedulePairSelector::synchronize(const std::vector<PictureRecord>& pictures) {
+    for (std::size_t i = positions.size(); i < pictures.size(); i++) {
+        positions[pictures[i].id] = i;
+
+        if (!pictures[i].removed)
+            schedule.add(pictures[i].id);
+    }
+}
+
+
+bool SchedulePairSelector::choose(const std::vector<PictureRecord>& pictures, const Filter& accept,
+                                    std::size_t& left, std::size_t& right) {
+    synchronize(pictures);
+
+    std::uint32_t first, second;
+    while (schedule.next(first, second)) {
+        auto firstPosition = positions.find(first);
+        auto secondPosition = positions.find(second);
+
+        // Not loaded yet, absent ones are dropped once loading ends
+        if (firstPosition == positions.end() || secondPosition == positions.end())
+            break;
+
+        left = firstPosition->second;
+        right = secondPosition->second;
+
+        if (pictures[left].removed) {
+            schedule.remove(first);
+            continue;
+        }
+
+        if (pictures[right].removed) {
+            schedule.remove(second);
+            continue;
+        }
+
+        // Near duplicates are not compared, the schedule places them
+        if (!accept(left, right)) {
+            schedule.tie();
+            continue;
+        }
+
+        // Sides are random, so the position does not hint the order
+        if (std::bernoulli_distribution(0.5)(gen))
+            std::swap(left, right);
+
+        return true;
+    }
+
+    return random.choose(pictures, accept, left, right);
+}
+
+
+void SchedulePairSelector::record(const std::vector<PictureRecord>& pictures, std::size_t winner, std::size_t loser) {
+    synchronize(pictures);
+    random.record(pictures, winner, loser);
+
+    // Answers to older questions are ignored
+    std::uint32_t first, second;
+    if (!schedule.next(first, second))
+        return;
+
+    std::uint32_t winnerId = pictures[winner].id;
+    std::uint32_t loserId = pictures[loser].id;
+
+    if (winnerId == first && loserId == second)
+        schedule.answer(true);
+    else if (winnerId == second && loserId == first)
+        schedule.answer(false);
+}
@@ -39,11 +39,27 @@ Screen::Screen(int width, int height, std::string windowName) : background(nullp
         SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE
     );
 
+    // Without a display (SDL_VIDEODRIVER=dummy) there is
+    // neither OpenGL nor acceleration
+    if (!window) {
+        window = SDL_CreateWindow(
+            "Picture ranking", 
+            SDL_WINDOWPOS_UNDEFINED, 
+            SDL_WINDOWPOS_UNDEFINED, 
+            width, 
+            height, 
+            SDL_WINDOW_RESIZABLE
+        );
+    }
+
     renderer = SDL_CreateRenderer(
         window, 
         -1,
         SDL_RENDERER_ACCELERATED
     );
+
+    if (!renderer)
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
 }
 
 
@@ -0,0 +1,259 @@
+#include "tournament_bracket.hpp"
+
+// C++ standard libraries
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+// Library for JSON handling
+#include "json.hpp"
+
+
+TournamentBracket::TournamentBracket(std::string path, std::size_t count) :
+        path(path.empty() ? path : path + "/tournament.json"),
+        count(std::max<std::size_t>(count, 1)),
+        leaves(1),
+        filled(0),
+        tree(2, empty),
+        ready(false),
+        modified(false) {
+    load();
+}
+
+
+void TournamentBracket::load() {
+    nlohmann::json data;
+
+    // No tournament yet, or a damaged one - start over
+    try {
+        std::ifstream file(path);
+        data = nlohmann::json::parse(file);
+
+        std::size_t savedLeaves = data.at("leaves").get<std::size_t>();
+        auto savedTree = data.at("tree").get<std::vector<std::int64_t>>();
+        auto savedDirty = data.at("dirty").get<std::vector<std::size_t>>();
+
+        if (savedLeaves == 0 || (savedLeaves & (savedLeaves - 1)) != 0 || savedTree.size() != 2 * savedLeaves)
+            return;
+
+        leaves = savedLeaves;
+        filled = std::min(data.at("filled").get<std::size_t>(), leaves);
+        tree = std::move(savedTree);
+        top = data.at("top").get<std::vector<std::uint32_t>>();
+
+        for (auto node : savedDirty) {
+            if (node >= 1 && node < leaves)
+                dirty.insert(node);
+        }
+    }
+    catch (...) {
+        return;
+    }
+
+    for (std::size_t leaf = leaves; leaf < 2 * leaves; leaf++) {
+        if (tree[leaf] != empty)
+            slots[tree[leaf]] = leaf;
+    }
+}
+
+
+void TournamentBracket::grow() {
+    std::vector<std::int64_t> grown(4 * leaves, empty);
+    std::set<std::size_t> grownDirty;
+
+    // Node i of level l moves by 2^l to the left half
+    for (std::size_t level = 1; level <= leaves; level *= 2) {
+        for (std::size_t node = level; node < 2 * level; node++)
+            grown[node + level] = tree[node];
+    }
+
+    for (auto node : dirty) {
+        std::size_t level = 1;
+        while (level * 2 <= node)
+            level *= 2;
+        grownDirty.insert(node + level);
+    }
+
+    for (auto& [id, leaf] : slots)
+        leaf += leaves;
+
+    // The right half is empty, the old winner goes on
+    grown[1] = grown[2];
+
+    tree = std::move(grown);
+    dirty = std::move(grownDirty);
+    leaves *= 2;
+}
+
+
+void TournamentBracket::resolve(std::size_t node, std::int64_t winner) {
+    dirty.erase(node);
+
+    if (tree[node] == winner)
+        return;
+
+    tree[node] = winner;
+    if (node > 1)
+        dirty.insert(node / 2);
+}
+
+
+void TournamentBracket::vacate(std::uint32_t id) {
+    auto slot = slots.find(id);
+    if (slot == slots.end())
+        return;
+
+    resolve(slot->second, empty);
+    slots.erase(slot);
+}
+
+
+void TournamentBracket::settle() {
+    while (top.size() < count) {
+        if (!dirty.empty()) {
+            // Children of the deepest node are decided
+            std::size_t node = *dirty.rbegin();
+            std::int64_t first = tree[2 * node];
+            std::int64_t second = tree[2 * node + 1];
+
+            // A real match waits for the vote
+            if (first != empty && second != empty)
+                return;
+
+            resolve(node, first != empty ? first : second);
+            continue;
+        }
+
+        // The root is the best of the rest
+        if (!ready || tree[1] == empty)
+            return;
+
+        std::uint32_t winner = tree[1];
+        top.push_back(winner);
+        vacate(winner);
+        modified = true;
+    }
+}
+
+
+void TournamentBracket::add(std::uint32_t id) {
+    if (slots.contains(id) || std::find(top.begin(), top.end(), id) != top.end())
+        return;
+
+    if (filled == leaves)
+        grow();
+
+    std::size_t leaf = leaves + filled++;
+    slots[id] = leaf;
+    tree[leaf] = empty;
+    resolve(leaf, id);
+
+    settle();
+    modified = true;
+}
+
+
+void TournamentBracket::remove(std::uint32_t id) {
+    auto winner = std::find(top.begin(), top.end(), id);
+    if (winner != top.end())
+        top.erase(winner);
+    else if (slots.contains(id))
+        vacate(id);
+    else
+        return;
+
+    settle();
+    modified = true;
+}
+
+
+void TournamentBracket::retain(const std::vector<PictureRecord>& pictures) {
+    std::unordered_set<std::uint32_t> present;
+    for (auto& picture : pictures) {
+        if (!picture.removed)
+            present.insert(picture.id);
+    }
+
+    std::vector<std::uint32_t> absent;
+    for (auto& [id, leaf] : slots) {
+        if (!present.contains(id))
+            absent.push_back(id);
+    }
+    for (auto id : top) {
+        if (!present.contains(id))
+            absent.push_back(id);
+    }
+
+    for (auto id : absent)
+        remove(id);
+
+    ready = true;
+    settle();
+}
+
+
+bool TournamentBracket::next(std::uint32_t& first, std::uint32_t& second) const {
+    if (isDone() || dirty.empty())
+        return false;
+
+    std::size_t node = *dirty.rbegin();
+    if (tree[2 * node] == empty || tree[2 * node + 1] == empty)
+        return false;
+
+    first = tree[2 * node];
+    second = tree[2 * node + 1];
+    return true;
+}
+
+
+void TournamentBracket::answer(bool firstWins) {
+    std::uint32_t first, second;
+    if (!next(first, second))
+        return;
+
+    resolve(*dirty.rbegin(), firstWins ? first : second);
+
+    settle();
+    modified = true;
+}
+
+
+void TournamentBracket::tie() {
+    // The second is not knocked out: it keeps its place in its half of the
+    // bracket and meets the rest again, once the first is crowned
+    answer(true);
+}
+
+
+bool TournamentBracket::isDone() const {
+    return top.size() >= count || (ready && dirty.empty() && tree[1] == empty);
+}
+
+
+const std::vector<std::uint32_t>& TournamentBracket::getOrder() const {
+    return top;
+}
+
+
+void TournamentBracket::save() {
+    if (!modified || path.empty())
+        return;
+
+    nlohmann::json data;
+    data["leaves"] = leaves;
+    data["filled"] = filled;
+    data["tree"] = tree;
+    data["dirty"] = std::vector<std::size_t>(dirty.begin(), dirty.end());
+    data["top"] = top;
+
+    std::ofstream file(path);
+    file << data;
+
+    if (!file) {
+        std::cout << "Could not save " << path << std::endl;
+        return;
+    }
+
+    modified = false;
+}
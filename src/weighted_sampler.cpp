@@ -0,0 +1,97 @@
+#include "weighted_sampler.hpp"
+
+WeightedSampler::WeightedSampler() :
+        tree(1, 0.0),
+        mask(0) {}
+
+
+void WeightedSampler::assign(const std::vector<double>& weights) {
+    this->weights = weights;
+    tree.assign(weights.size() + 1, 0.0);
+
+    // Every node passes its sum to the parent
+    for (std::size_t i = 1; i < tree.size(); i++) {
+        tree[i] += weights[i - 1];
+
+        std::size_t parent = i + (i & -i);
+        if (parent < tree.size())
+            tree[parent] += tree[i];
+    }
+
+    mask = weights.empty() ? 0 : 1;
+    while (mask * 2 <= weights.size())
+        mask *= 2;
+}
+
+
+void WeightedSampler::push(double weight) {
+    weights.push_back(weight);
+
+    // The new node covers (i - lowbit(i), i]
+    std::size_t i = weights.size();
+    tree.push_back(weight + prefix(i - 1) - prefix(i - (i & -i)));
+
+    if (mask == 0 || mask * 2 <= weights.size())
+        mask = mask ? mask * 2 : 1;
+}
+
+
+void WeightedSampler::set(std::size_t index, double weight) {
+    double delta = weight - weights[index];
+    weights[index] = weight;
+
+    for (std::size_t i = index + 1; i < tree.size(); i += i & -i)
+        tree[i] += delta;
+}
+
+
+double WeightedSampler::get(std::size_t index) const {
+    return weights[index];
+}
+
+
+double WeightedSampler::prefix(std::size_t index) const {
+    double sum = 0.0;
+    for (std::size_t i = index; i > 0; i -= i & -i)
+        sum += tree[i];
+
+    return sum;
+}
+
+
+double WeightedSampler::total() const {
+    return prefix(weights.size());
+}
+
+
+std::size_t WeightedSampler::size() const {
+    return weights.size();
+}
+
+
+std::size_t WeightedSampler::find(double target) const {
+    // Descend from the largest node, skipping whole subtrees
+    std::size_t position = 0;
+    for (std::size_t step = mask; step > 0; step /= 2) {
+        std::size_t next = position + step;
+        if (next < tree.size() && tree[next] <= target) {
+            position = next;
+            target -= tree[next];
+        }
+    }
+
+    // Rounding may run past the last positive weight
+    while (position > 0 && (position >= weights.size() || weights[position] <= 0.0))
+        position--;
+
+    return position;
+}
+
+
+std::size_t WeightedSampler::sample(std::mt19937& gen) const {
+    double sum = total();
+    if (weights.empty() || sum <= 0.0)
+        return weights.size();
+
+    return find(std::uniform_real_distribution<double>(0.0, sum)(gen));
+}
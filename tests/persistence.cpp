@@ -0,0 +1,221 @@
+// C++ standard libraries
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Custom libraries
+#include "comparison_log.hpp"
+#include "comparison_schedule.hpp"
+#include "insertion_sorter.hpp"
+#include "picture_names.hpp"
+#include "picture_record.hpp"
+#include "scan_manifest.hpp"
+#include "tournament_bracket.hpp"
+
+
+static bool passed = true;
+
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "Failed: " << what << std::endl;
+        passed = false;
+    }
+}
+
+
+// Empty directory of the test in the temporary directory
+static std::string makeDirectory(const std::string& name) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / ("rank-tests-" + name);
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory.string();
+}
+
+
+// Comparisons of two sessions, several chunks each, read back in order.
+// Ids are of every varint length
+static void testComparisonLog() {
+    std::string directory = makeDirectory("log");
+    std::string path = directory + "/comparisons.bin";
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> written;
+    for (std::uint32_t i = 0; i < 1000; i++)
+        written.emplace_back(i * 4294967u, 0xFFFFFFFFu - i);
+
+    std::uint64_t sessions[2];
+    for (int session = 0; session < 2; session++) {
+        ComparisonLog log(path, 64);
+        sessions[session] = log.getSession();
+
+        for (std::size_t i = session * 500; i < (session + 1) * 500u; i++)
+            log.record(written[i].first, written[i].second);
+    }
+
+    ComparisonLogReader reader(path);
+    check(reader.isOpen(), "log is open");
+    check(reader.count() == written.size(), "log count");
+
+    std::vector<Comparison> comparisons = reader.readAll();
+    check(comparisons.size() == written.size(), "log size");
+    for (std::size_t i = 0; i < comparisons.size() && i < written.size(); i++) {
+        if (comparisons[i].winner != written[i].first || comparisons[i].loser != written[i].second) {
+            check(false, "log comparison " + std::to_string(i));
+            break;
+        }
+
+        if (comparisons[i].session != sessions[i / 500]) {
+            check(false, "log session of comparison " + std::to_string(i));
+            break;
+        }
+
+        if (i > 0 && comparisons[i].timestamp < comparisons[i - 1].timestamp) {
+            check(false, "log timestamp of comparison " + std::to_string(i));
+            break;
+        }
+    }
+
+    // A log without a path keeps nothing
+    {
+        ComparisonLog log("");
+        log.record(1, 2);
+    }
+    check(ComparisonLogReader("").count() == 0, "log without a path");
+
+    std::filesystem::remove_all(directory);
+}
+
+
+// Runs the schedule with the larger id winning, saving and loading it
+// again every few votes. The questions go on where they stopped
+static std::unique_ptr<ComparisonSchedule> runSchedule(const std::string& name,
+                        const std::function<std::unique_ptr<ComparisonSchedule>(const std::string&)>& make) {
+    std::string directory = makeDirectory(name);
+
+    std::vector<PictureRecord> pictures(50);
+    for (std::uint32_t i = 0; i < pictures.size(); i++)
+        pictures[i].id = (i * 17) % pictures.size();
+
+    std::unique_ptr<ComparisonSchedule> schedule = make(directory);
+    for (auto& picture : pictures)
+        schedule->add(picture.id);
+    schedule->retain(pictures);
+
+    std::size_t votes = 0;
+    std::uint32_t first, second;
+    while (schedule->next(first, second) && votes < 10000) {
+        schedule->answer(first > second);
+        votes++;
+
+        if (votes % 7 == 0) {
+            schedule->save();
+            bool asked = schedule->next(first, second);
+
+            // As the next session, the pictures are found again
+            schedule = make(directory);
+            for (auto& picture : pictures)
+                schedule->add(picture.id);
+            schedule->retain(pictures);
+
+            std::uint32_t resumedFirst, resumedSecond;
+            bool resumed = schedule->next(resumedFirst, resumedSecond);
+            if (resumed != asked || (asked && (resumedFirst != first || resumedSecond != second))) {
+                check(false, name + " resumes after " + std::to_string(votes) + " votes");
+                break;
+            }
+        }
+    }
+
+    check(schedule->isDone(), name + " is done");
+    std::filesystem::remove_all(directory);
+    return schedule;
+}
+
+
+static void testInsertionSorter() {
+    auto sorter = runSchedule("sort", [](const std::string& path) {
+        return std::make_unique<InsertionSorter>(path);
+    });
+
+    const std::vector<std::uint32_t>& order = sorter->getOrder();
+    check(order.size() == 50, "sort places every picture");
+    for (std::size_t place = 0; place < order.size(); place++) {
+        if (order[place] != 49 - place) {
+            check(false, "sort order at " + std::to_string(place));
+            break;
+        }
+    }
+}
+
+
+static void testTournamentBracket() {
+    auto bracket = runSchedule("top", [](const std::string& path) {
+        return std::make_unique<TournamentBracket>(path, 5);
+    });
+
+    check(bracket->getOrder() == std::vector<std::uint32_t>{49, 48, 47, 46, 45}, "tournament top 5");
+}
+
+
+// A directory with two pictures, one hashed before the save:
+// both come back, only the hashed one is cached
+static void testScanManifest() {
+    std::string directory = makeDirectory("manifest");
+    std::string pictures = directory + "/pictures";
+    std::filesystem::create_directories(pictures);
+
+    {
+        ScanManifest manifest(directory);
+        std::string names = std::string("a.jpg") + '\0' + "b.jpg" + '\0';
+        manifest.updateDirectory(pictures, 5, "", names);
+        manifest.updateFile(pictures + "/a.jpg", ScanManifest::FileEntry{1, 2, 3, 4});
+        manifest.save();
+    }
+
+    ScanManifest manifest(directory);
+    PictureNames names;
+    std::vector<PictureRecord> restored;
+    std::vector<std::string> subdirectories;
+    check(manifest.restore(pictures, 5, names, restored, subdirectories), "manifest restores the directory");
+    check(restored.size() == 2, "manifest restores both pictures");
+    check(subdirectories.empty(), "manifest restores no subdirectories");
+
+    ScanManifest::FileEntry entry;
+    check(manifest.findFile(pictures + "/a.jpg", entry) && entry.hash == 3 && entry.perceptual == 4, "manifest keeps the hash");
+    check(!manifest.findFile(pictures + "/b.jpg", entry), "manifest caches no unhashed file");
+
+    // A changed directory is listed again
+    check(!manifest.restore(pictures, 6, names, restored, subdirectories), "manifest lists a changed directory");
+
+    std::filesystem::remove_all(directory);
+}
+
+
+// Persistence of the comparison log, the sort, the tournament and the
+// scan manifest. Runs the test given by name, or all of them
+int main(int argc, char* argv[]) {
+    const std::map<std::string, std::function<void()>> tests{
+        {"comparison_log", testComparisonLog},
+        {"insertion_sorter", testInsertionSorter},
+        {"tournament_bracket", testTournamentBracket},
+        {"scan_manifest", testScanManifest}
+    };
+
+    for (auto& [name, test] : tests) {
+        if (argc < 2 || name == argv[1])
+            test();
+    }
+
+    if (argc >= 2 && !tests.contains(argv[1])) {
+        std::cerr << "Unknown test " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,134 @@
+// C++ standard libraries
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Custom libraries
+#include "bradley_terry.hpp"
+#include "comparison_log.hpp"
+#include "data_handler.hpp"
+#include "picture_names.hpp"
+#include "picture_record.hpp"
+
+
+static const char* usage = "Usage: rank-bt [-t tolerance] [-i iterations] [-j threads] [-n top] [folder]";
+
+
+// Whole argument as a number, not negative
+template<typename T>
+static bool parseNumber(const char* text, T& value) {
+    T parsed;
+    const char* end = text + std::strlen(text);
+    auto [last, error] = std::from_chars(text, end, parsed);
+    if (error != std::errc() || last != end || last == text || parsed < 0)
+        return false;
+
+    value = parsed;
+    return true;
+}
+
+
+// Field of a CSV line, quoted if it has commas, quotes or line breaks
+static std::string quote(std::string_view field) {
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos)
+        return std::string(field);
+
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+
+    return quoted + '"';
+}
+
+
+// Offline ranking of the folder by a Bradley-Terry fit
+// over every comparison in its log.
+// Prints the ranking as CSV: rank, name, rating, wins, total
+int main(int argc, char* argv[]) {
+    std::string pathToPictures = "test";
+    BradleyTerryOptions options;
+    std::size_t top = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool valid = true;
+
+        if (argument == "-t" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.tolerance);
+        else if (argument == "-i" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.maxIterations);
+        else if (argument == "-j" && i + 1 < argc)
+            valid = parseNumber(argv[++i], options.threads);
+        else if (argument == "-n" && i + 1 < argc)
+            valid = parseNumber(argv[++i], top);
+        else if (argument.starts_with("-"))
+            valid = false;
+        else
+            pathToPictures = argument;
+
+        if (!valid) {
+            std::cerr << "Invalid argument " << argv[i] << std::endl << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    ComparisonLogReader log(pathToPictures + "/comparisons.bin");
+    if (!log.isOpen()) {
+        std::cerr << "No comparisons in " << pathToPictures << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Fit //
+
+    auto start = std::chrono::steady_clock::now();
+
+    BradleyTerry model;
+    model.build(log, options.threads);
+
+    auto built = std::chrono::steady_clock::now();
+
+    bool converged = model.solve(options);
+
+    auto solved = std::chrono::steady_clock::now();
+
+    std::cerr << model.getPictureCount() << " pictures, " << model.getPairCount() << " pairs: "
+              << "built in " << std::chrono::duration<double>(built - start).count() << " s, "
+              << (converged ? "converged" : "stopped") << " after " << model.getIterations()
+              << " iterations in " << std::chrono::duration<double>(solved - built).count() << " s"
+              << " (change " << model.getChange() << ")" << std::endl;
+
+    // Names from the statistics //
+
+    PictureNames names;
+    DataHandler dataHandler(pathToPictures, names);
+    dataHandler.load();
+
+    std::vector<PictureRecord> pictures;
+    dataHandler.getRecords(pictures);
+
+    std::sort(pictures.begin(), pictures.end(),
+        [&model](const PictureRecord& first, const PictureRecord& second) {
+            return model.getRating(first.id) > model.getRating(second.id);
+        }
+    );
+
+    if (top != 0 && top < pictures.size())
+        pictures.resize(top);
+
+    std::cout << "rank,name,rating,wins,total\n" << std::fixed << std::setprecision(1);
+    for (std::size_t i = 0; i < pictures.size(); i++) {
+        std::cout << i + 1 << ',' << quote(names.getName(pictures[i].file)) << ',' << model.getRating(pictures[i].id) << ','
+                  << pictures[i].wins << ',' << pictures[i].total << '\n';
+    }
+
+    return EXIT_SUCCESS;
+}